@@ -0,0 +1,67 @@
+#include "AsyncWriter.h"
+
+#include <stdexcept>
+
+AsyncWriter::AsyncWriter(std::string const &path)
+    : out(path, std::ios::binary | std::ios::trunc),
+      front(0),
+      pending(false),
+      closing(false),
+      failed(false) {
+  if (!out)
+    throw std::runtime_error("Cannot open " + path + " for writing");
+  writer = std::thread(&AsyncWriter::run, this);
+}
+
+AsyncWriter::~AsyncWriter() {
+  try {
+    Close();
+  } catch (const std::runtime_error &) {
+  }
+}
+
+void AsyncWriter::run() {
+  std::unique_lock<std::mutex> lock(mtx);
+  while (true) {
+    cv.wait(lock, [this]() { return pending || closing; });
+    if (!pending)
+      return;
+
+    // The back buffer is owned by this thread until `pending` is cleared.
+    std::string &back = buffers[1 - front];
+    lock.unlock();
+    out.write(back.data(), back.size());
+    const bool ok = static_cast<bool>(out);
+    back.clear();
+    lock.lock();
+
+    failed = failed || !ok;
+    pending = false;
+    cv.notify_all();
+  }
+}
+
+void AsyncWriter::Flush() {
+  std::unique_lock<std::mutex> lock(mtx);
+  cv.wait(lock, [this]() { return !pending; });
+  if (buffers[front].empty())
+    return;
+  front = 1 - front;
+  pending = true;
+  cv.notify_all();
+}
+
+void AsyncWriter::Close() {
+  if (!writer.joinable())
+    return;
+  Flush();
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    closing = true;
+  }
+  cv.notify_all();
+  writer.join();
+  out.flush();
+  if (failed || !out)
+    throw std::runtime_error("Failed writing output file");
+}
@@ -0,0 +1,45 @@
+#ifndef MLPACK_PROJECT_ASYNC_WRITER_H
+#define MLPACK_PROJECT_ASYNC_WRITER_H
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Double-buffered file writer. The caller fills Buffer() and calls Flush();
+// a background thread writes that buffer while the caller fills the other one.
+// Flush() only blocks if the previous buffer has not been written yet.
+class AsyncWriter {
+private:
+  std::ofstream out;
+  std::string buffers[2];
+  size_t front;
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  bool pending;
+  bool closing;
+  bool failed;
+  std::thread writer;
+
+  void run();
+
+public:
+  // Throws std::runtime_error if the file cannot be opened.
+  explicit AsyncWriter(std::string const &path);
+  ~AsyncWriter();
+
+  AsyncWriter(const AsyncWriter &) = delete;
+  AsyncWriter &operator=(const AsyncWriter &) = delete;
+
+  std::string &Buffer() { return buffers[front]; }
+
+  void Flush();
+
+  // Writes any remaining data and waits for the writer thread.
+  // Throws std::runtime_error if a write failed.
+  void Close();
+};
+
+#endif // MLPACK_PROJECT_ASYNC_WRITER_H
@@ -0,0 +1,166 @@
+#include "BatchScorer.h"
+
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include "AsyncWriter.h"
+#include "../util/Csv.h"
+#include "../util/Json.h"
+#include "../util/Parallel.h"
+
+namespace {
+
+// Significant digits of the scores written to the output CSV.
+const int SCORE_DIGITS = 6;
+
+} // namespace
+
+BatchScorer::BatchScorer(
+    CategoricalEncoder const &encoder,
+    std::vector<std::string> const &dimensionToDataField,
+    LinearRegression const &lr,
+    DecisionTree<> const &dt,
+    FFN<MeanSquaredError, RandomInitialization> const &nn,
+    data::MinMaxScaler &scalar,
+    size_t threads)
+    : encoder(encoder),
+      dimensionToDataField(dimensionToDataField),
+      lr(lr),
+      dt(dt),
+      nn(nn),
+      scalar(scalar),
+      threads(threads == 0 ? defaultThreadCount() : threads) {}
+
+bool BatchScorer::readHeader(std::string const &line) {
+  std::vector<CsvField> fields;
+  splitCsvLine(line, fields);
+
+  columnOfDimension.assign(dimensionToDataField.size(), 0);
+  for (size_t dim = 0; dim < dimensionToDataField.size(); ++dim) {
+    bool found = false;
+    for (size_t col = 0; col < fields.size() && !found; ++col) {
+      if (std::string(fields[col].first, fields[col].second) == dimensionToDataField[dim]) {
+        columnOfDimension[dim] = col;
+        found = true;
+      }
+    }
+    if (!found) {
+      // Not a header: use the training column order.
+      for (size_t i = 0; i < columnOfDimension.size(); ++i)
+        columnOfDimension[i] = i;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool BatchScorer::encodeRow(
+    std::string const &line,
+    std::vector<CsvField> &fields,
+    double *out) const {
+  splitCsvLine(line, fields);
+  try {
+    for (size_t dim = 0; dim < columnOfDimension.size(); ++dim) {
+      const size_t col = columnOfDimension[dim];
+      if (col >= fields.size())
+        return false;
+      const CsvField field = trimCsvField(fields[col]);
+      out[dim] = encoder.Encode(dim, field.first, field.second);
+    }
+  } catch (const std::runtime_error &) {
+    return false;
+  }
+  return true;
+}
+
+BatchScorer::Summary BatchScorer::Score(
+    std::string const &inputPath,
+    std::string const &outputPath,
+    size_t chunkRows) {
+  const auto start = std::chrono::steady_clock::now();
+
+  std::ifstream in(inputPath);
+  if (!in)
+    throw std::runtime_error("Cannot open " + inputPath);
+  AsyncWriter writer(outputPath);
+
+  const size_t dims = dimensionToDataField.size();
+  const size_t grain = 1024;
+
+  // One network per worker: FFN::Predict keeps per-call state in the model.
+  std::vector<FFN<MeanSquaredError, RandomInitialization>> networks(threads, nn);
+  std::vector<std::vector<CsvField>> fieldScratch(threads);
+
+  std::vector<std::string> lines, nextLines;
+  size_t n = readCsvLines(in, lines, chunkRows);
+  size_t first = 0;
+  if (n > 0 && readHeader(lines[0]))
+    first = 1;
+
+  writer.Buffer() += "lr,dt,dt_probability,nn\n";
+
+  Summary summary{0, 0, 0};
+  arma::mat input;
+  std::vector<char> valid;
+  std::vector<std::string> blockOutput;
+
+  while (n > first) {
+    // Read the next chunk while this one is scored.
+    std::future<size_t> next = std::async(std::launch::async, [&]() {
+      return readCsvLines(in, nextLines, chunkRows);
+    });
+
+    const size_t rows = n - first;
+    input.set_size(dims, rows);
+    valid.assign(rows, 0);
+    blockOutput.assign((rows + grain - 1) / grain, std::string());
+
+    parallelFor(rows, grain, [&](size_t worker, size_t begin, size_t end) {
+      for (size_t r = begin; r < end; ++r)
+        valid[r] = encodeRow(lines[first + r], fieldScratch[worker], input.colptr(r));
+
+      arma::mat block = input.cols(begin, end - 1);
+      arma::rowvec lrScores, nnScores;
+      arma::Row<size_t> dtClasses;
+      arma::mat dtProbabilities, scaledBlock;
+      lr.Predict(block, lrScores);
+      dt.Classify(block, dtClasses, dtProbabilities);
+      scalar.Transform(block, scaledBlock);
+      networks[worker].Predict(scaledBlock, nnScores);
+
+      std::string &out = blockOutput[begin / grain];
+      out.reserve((end - begin) * 40);
+      for (size_t r = begin, i = 0; r < end; ++r, ++i) {
+        if (valid[r]) {
+          appendNumber(out, lrScores(i), SCORE_DIGITS);
+          out += ',';
+          appendNumber(out, (double)dtClasses(i), SCORE_DIGITS);
+          out += ',';
+          appendNumber(out, dtProbabilities.n_rows > 1 ? dtProbabilities(1, i) : 0.0, SCORE_DIGITS);
+          out += ',';
+          appendNumber(out, nnScores(i), SCORE_DIGITS);
+          out += '\n';
+        } else {
+          out += ",,,\n";
+        }
+      }
+    }, threads);
+
+    for (std::string const &out : blockOutput)
+      writer.Buffer() += out;
+    writer.Flush();
+
+    summary.rows += rows;
+    for (char ok : valid)
+      summary.rejected += !ok;
+
+    n = next.get();
+    first = 0;
+    lines.swap(nextLines);
+  }
+
+  writer.Close();
+  summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return summary;
+}
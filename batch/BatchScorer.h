@@ -0,0 +1,57 @@
+#ifndef MLPACK_PROJECT_BATCH_SCORER_H
+#define MLPACK_PROJECT_BATCH_SCORER_H
+
+#include <string>
+#include <vector>
+#include <mlpack.hpp>
+#include "../encoder/CategoricalEncoder.h"
+#include "../util/Csv.h"
+
+using namespace mlpack;
+
+// Scores a CSV file with the linear regression, decision tree and neural
+// network models without going through the HTTP server.
+//
+// The input is read in chunks of rows. While one chunk is encoded and scored
+// across all cores, the next one is read from disk and the previous results
+// are written by an AsyncWriter. Columns are matched to features by name when
+// the first line is a header, otherwise the first 19 columns are taken in the
+// training order. Output rows line up with input rows; a row that cannot be
+// encoded is written with empty scores.
+class BatchScorer {
+private:
+  CategoricalEncoder const &encoder;
+  std::vector<std::string> dimensionToDataField;
+  LinearRegression const &lr;
+  DecisionTree<> const &dt;
+  FFN<MeanSquaredError, RandomInitialization> const &nn;
+  data::MinMaxScaler &scalar;
+  size_t threads;
+
+  // Column of the input line holding each feature.
+  std::vector<size_t> columnOfDimension;
+
+  bool readHeader(std::string const &line);
+  bool encodeRow(std::string const &line, std::vector<CsvField> &fields, double *out) const;
+
+public:
+  BatchScorer(
+      CategoricalEncoder const &encoder,
+      std::vector<std::string> const &dimensionToDataField,
+      LinearRegression const &lr,
+      DecisionTree<> const &dt,
+      FFN<MeanSquaredError, RandomInitialization> const &nn,
+      data::MinMaxScaler &scalar,
+      size_t threads = 0);
+
+  struct Summary {
+    size_t rows;
+    size_t rejected;
+    double seconds;
+  };
+
+  // Throws std::runtime_error if either file cannot be opened.
+  Summary Score(std::string const &inputPath, std::string const &outputPath, size_t chunkRows = 65536);
+};
+
+#endif // MLPACK_PROJECT_BATCH_SCORER_H
@@ -0,0 +1,188 @@
+#include <mlpack.hpp>
+#include "../crow_all.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sys/stat.h>
+#include "../generator/ModelGenerator.h"
+#include "../deserializer/PredictRequestDeserializer.h"
+#include "../scoring/FlatTree.h"
+#include "../scoring/GeneratedTree.h"
+
+using namespace mlpack;
+
+// Micro-benchmark of the request hot path: JSON parsing, feature encoding and
+// single-row inference for each model. Build it in two configurations
+// (`make bench-compare`) to see what the optimisation flags buy.
+//
+// Usage: bench.o [iterations] [--nn]
+// --nn also trains the neural network, which takes a while at -O0.
+
+namespace {
+
+const char *SAMPLE_BODY = R"({
+  "gender": "Female", "SeniorCitizen": 0, "Partner": "Yes", "Dependents": "Yes",
+  "tenure": 58.0, "PhoneService": "No", "MultipleLines": "No phone service",
+  "InternetService": "DSL", "OnlineSecurity": "No", "OnlineBackup": "No",
+  "DeviceProtection": "Yes", "TechSupport": "Yes", "StreamingTV": "Yes",
+  "StreamingMovies": "Yes", "Contract": "Two year", "PaperlessBilling": "Yes",
+  "PaymentMethod": "Electronic check", "MonthlyCharges": 55.5, "TotalCharges": 1421
+})";
+
+bool fileExists(const char *path) {
+  struct stat st;
+  return stat(path, &st) == 0;
+}
+
+// Runs fn `iterations` times and prints the mean time per call.
+template<typename F>
+void measure(const std::string &name, size_t iterations, F fn) {
+  // Warm up caches and lazy initialisation before timing.
+  for (size_t i = 0; i < iterations / 10 + 1; ++i)
+    fn();
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i)
+    fn();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  double nsPerOp = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+  std::cout << std::left << std::setw(28) << name
+    << std::right << std::setw(14) << std::fixed << std::setprecision(1) << nsPerOp
+    << " ns/op" << '\n';
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t iterations = 100000;
+  bool withNN = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--nn")
+      withNN = true;
+    else
+      iterations = std::stoul(arg);
+  }
+
+  crow::logger::setLogLevel(crow::LogLevel::Warning);
+
+  arma::mat dataset;
+  data::DatasetInfo info;
+  data::Load("data/cleaned_credit_data.csv", dataset, info);
+  ModelGenerator modelGenerator(dataset);
+
+  if (!fileExists("models/lr.bin") || !fileExists("models/dt.bin")) {
+    mkdir("models", 0755);
+    modelGenerator.generateBaseLinReg();
+    modelGenerator.generateBaseDT();
+  }
+
+  LinearRegression lr;
+  DecisionTree<> dt;
+  FFN<MeanSquaredError, RandomInitialization> nn;
+  data::MinMaxScaler scalar;
+  data::Load("models/lr.bin", "lr", lr);
+  data::Load("models/dt.bin", "dt", dt);
+  data::Load("data/scalar.bin", "scalar", scalar);
+  if (withNN)
+    modelGenerator.generateBaseFNN(nn);
+
+  std::vector<std::string> dimensionToDataField = {
+    "gender", "SeniorCitizen", "Partner", "Dependents", "tenure",
+    "PhoneService", "MultipleLines", "InternetService", "OnlineSecurity",
+    "OnlineBackup", "DeviceProtection", "TechSupport", "StreamingTV",
+    "StreamingMovies", "Contract", "PaperlessBilling", "PaymentMethod",
+    "MonthlyCharges", "TotalCharges"};
+  PredictRequestDeserializer deserializer(info, dimensionToDataField);
+
+  const std::string body = SAMPLE_BODY;
+  auto parsed = crow::json::load(body);
+  arma::colvec input(19);
+  deserializer.convertRequestBodyToInput(parsed, input);
+
+  std::cout << std::left << std::setw(28) << "benchmark"
+    << std::right << std::setw(14) << "time" << '\n';
+
+  measure("json::load", iterations, [&]() {
+    auto json = crow::json::load(body);
+    if (!json)
+      std::abort();
+  });
+
+  measure("convertRequestBodyToInput", iterations, [&]() {
+    deserializer.convertRequestBodyToInput(parsed, input);
+  });
+
+  measure("lr.Predict", iterations, [&]() {
+    arma::rowvec predictions;
+    lr.Predict(input, predictions);
+  });
+
+  measure("dt.Classify", iterations, [&]() {
+    arma::Row<size_t> predictions;
+    dt.Classify(input, predictions);
+  });
+
+  // The same tree flattened into an array, and compiled to native code.
+  FlatTree flatTree = FlatTree::Build(dt, dimensionToDataField.size());
+  GeneratedTree generatedTree;
+  try {
+    generatedTree.Build(flatTree, dimensionToDataField, "models/dt.bin", "models/dt_gen");
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << '\n';
+  }
+
+  measure("FlatTree::Classify", iterations, [&]() {
+    if (flatTree.Classify(input.memptr()) > 1)
+      std::abort();
+  });
+
+  if (generatedTree.Loaded()) {
+    measure("GeneratedTree::Classify", iterations, [&]() {
+      if (generatedTree.Classify(input.memptr()) > 1)
+        std::abort();
+    });
+  }
+
+  if (withNN) {
+    measure("nn.Predict", iterations, [&]() {
+      arma::colvec scaledInput;
+      scalar.Transform(input, scaledInput);
+      arma::rowvec predictions;
+      nn.Predict(scaledInput, predictions);
+    });
+  }
+
+  arma::mat dataX = dataset.submat(0, 0, dataset.n_rows - 2, dataset.n_cols - 1);
+  measure("lr.Predict (full dataset)", std::max<size_t>(1, iterations / 1000), [&]() {
+    arma::rowvec predictions;
+    lr.Predict(dataX, predictions);
+  });
+  measure("dt.Classify (full dataset)", std::max<size_t>(1, iterations / 1000), [&]() {
+    arma::Row<size_t> predictions;
+    dt.Classify(dataX, predictions);
+  });
+  measure("FlatTree (full dataset)", std::max<size_t>(1, iterations / 1000), [&]() {
+    arma::Row<size_t> predictions(dataX.n_cols);
+    for (size_t i = 0; i < dataX.n_cols; ++i)
+      predictions[i] = flatTree.Classify(dataX.colptr(i));
+  });
+  if (generatedTree.Loaded()) {
+    measure("GeneratedTree (full dataset)", std::max<size_t>(1, iterations / 1000), [&]() {
+      arma::Row<size_t> predictions(dataX.n_cols);
+      for (size_t i = 0; i < dataX.n_cols; ++i)
+        predictions[i] = generatedTree.Classify(dataX.colptr(i));
+    });
+
+    // The generated code must agree with the tree it came from.
+    arma::Row<size_t> expected;
+    dt.Classify(dataX, expected);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < dataX.n_cols; ++i)
+      mismatches += generatedTree.Classify(dataX.colptr(i)) != expected[i];
+    std::cout << "GeneratedTree mismatches: " << mismatches << " of " << dataX.n_cols << '\n';
+  }
+
+  return 0;
+}
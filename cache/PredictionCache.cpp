@@ -0,0 +1,118 @@
+#include "PredictionCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace {
+
+uint64_t mix(uint64_t h, uint64_t v) {
+  // splitmix64 finalizer folded into the running hash.
+  h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return h;
+}
+
+bool sameFeatures(std::vector<double> const &cached, const double *features, size_t n) {
+  return cached.size() == n && std::equal(cached.begin(), cached.end(), features);
+}
+
+} // namespace
+
+PredictionCache::PredictionCache(size_t capacity, size_t numShards)
+    : capacity(capacity),
+      hits(0),
+      misses(0),
+      evictions(0) {
+  if (capacity == 0)
+    return;
+  numShards = std::max<size_t>(1, std::min(numShards, capacity));
+  for (size_t i = 0; i < numShards; ++i) {
+    shards.emplace_back(new Shard());
+    shards.back()->capacity = capacity / numShards + (i < capacity % numShards);
+  }
+}
+
+uint64_t PredictionCache::hashKey(uint32_t model, uint64_t version, const double *features, size_t n) {
+  uint64_t h = mix(model, version);
+  for (size_t i = 0; i < n; ++i) {
+    // Canonicalise so -0.0 and 0.0 hash the same; they compare equal too.
+    double value = features[i] == 0.0 ? 0.0 : features[i];
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    h = mix(h, bits);
+  }
+  return h;
+}
+
+PredictionCache::Shard &PredictionCache::shardFor(uint64_t hash) {
+  return *shards[(hash >> 48) % shards.size()];
+}
+
+bool PredictionCache::lookup(uint32_t model, uint64_t version, const double *features, size_t n, std::string &response) {
+  if (!enabled())
+    return false;
+
+  const uint64_t hash = hashKey(model, version, features, n);
+  Shard &shard = shardFor(hash);
+  {
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    auto it = shard.index.find(hash);
+    if (it != shard.index.end()) {
+      Entry &entry = *it->second;
+      if (entry.model == model && entry.version == version && sameFeatures(entry.features, features, n)) {
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        response = entry.response;
+        ++hits;
+        return true;
+      }
+    }
+  }
+  ++misses;
+  return false;
+}
+
+void PredictionCache::insert(uint32_t model, uint64_t version, const double *features, size_t n, std::string const &response) {
+  if (!enabled())
+    return;
+
+  const uint64_t hash = hashKey(model, version, features, n);
+  Shard &shard = shardFor(hash);
+  std::lock_guard<std::mutex> lock(shard.mtx);
+
+  // A hash collision or a stale version simply replaces the old entry.
+  auto it = shard.index.find(hash);
+  if (it != shard.index.end()) {
+    shard.lru.erase(it->second);
+    shard.index.erase(it);
+  }
+
+  while (shard.lru.size() >= shard.capacity) {
+    shard.index.erase(shard.lru.back().hash);
+    shard.lru.pop_back();
+    ++evictions;
+  }
+
+  shard.lru.push_front(Entry{hash, model, version, std::vector<double>(features, features + n), response});
+  shard.index[hash] = shard.lru.begin();
+}
+
+std::string PredictionCache::Report() {
+  size_t entries = 0;
+  for (auto &shard : shards) {
+    std::lock_guard<std::mutex> lock(shard->mtx);
+    entries += shard->lru.size();
+  }
+
+  std::ostringstream out;
+  out << "cache entries: " << entries << '/' << capacity
+    << "  hits: " << hits.load()
+    << "  misses: " << misses.load()
+    << "  evictions: " << evictions.load()
+    << '\n';
+  return out.str();
+}
@@ -0,0 +1,59 @@
+#ifndef MLPACK_PROJECT_PREDICTION_CACHE_H
+#define MLPACK_PROJECT_PREDICTION_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Sharded LRU cache of prediction responses.
+// Entries are keyed by the encoded feature vector, the model that produced the
+// response and the model version, so reloading the models invalidates every
+// cached response without a flush. Each shard has its own lock and an equal
+// share of the capacity given at construction (shares differ by at most one
+// entry), so the cache holds at most exactly that many entries. A capacity
+// below the shard count uses one shard per entry. A capacity of 0 disables
+// the cache.
+class PredictionCache {
+private:
+  struct Entry {
+    uint64_t hash;
+    uint32_t model;
+    uint64_t version;
+    std::vector<double> features;
+    std::string response;
+  };
+
+  struct Shard {
+    std::mutex mtx;
+    std::list<Entry> lru;  // Most recently used at the front.
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    size_t capacity;
+  };
+
+  size_t capacity;
+  std::vector<std::unique_ptr<Shard>> shards;
+
+  std::atomic<uint64_t> hits;
+  std::atomic<uint64_t> misses;
+  std::atomic<uint64_t> evictions;
+
+  static uint64_t hashKey(uint32_t model, uint64_t version, const double *features, size_t n);
+  Shard &shardFor(uint64_t hash);
+
+public:
+  PredictionCache(size_t capacity, size_t numShards = 16);
+
+  bool enabled() const { return capacity > 0; }
+
+  bool lookup(uint32_t model, uint64_t version, const double *features, size_t n, std::string &response);
+  void insert(uint32_t model, uint64_t version, const double *features, size_t n, std::string const &response);
+
+  std::string Report();
+};
+
+#endif // MLPACK_PROJECT_PREDICTION_CACHE_H
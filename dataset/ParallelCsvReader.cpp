@@ -0,0 +1,268 @@
+#include "ParallelCsvReader.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_set>
+#include "../util/Csv.h"
+#include "../util/Parallel.h"
+
+namespace {
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+private:
+  const char *data;
+  size_t size;
+public:
+  explicit MappedFile(std::string const &path) : data(nullptr), size(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("Cannot open " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      throw std::runtime_error("Cannot stat " + path);
+    }
+    size = static_cast<size_t>(st.st_size);
+    if (size > 0) {
+      void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("Cannot map " + path);
+      }
+      madvise(mapped, size, MADV_SEQUENTIAL);
+      data = static_cast<const char *>(mapped);
+    }
+    close(fd);
+  }
+
+  ~MappedFile() {
+    if (data)
+      munmap(const_cast<char *>(data), size);
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *begin() const { return data; }
+  const char *end() const { return data + size; }
+};
+
+struct Chunk {
+  const char *begin;
+  const char *end;
+  size_t firstRow;
+  size_t rows;
+};
+
+// Splits the file into about `count` chunks that each end after a newline.
+std::vector<Chunk> splitChunks(MappedFile const &file, size_t count) {
+  std::vector<Chunk> chunks;
+  const char *p = file.begin();
+  const size_t size = file.end() - file.begin();
+  for (size_t i = 1; p < file.end(); ++i) {
+    const char *end = (i >= count) ? file.end() : file.begin() + size * i / count;
+    if (end <= p)
+      end = p + 1;
+    while (end < file.end() && end[-1] != '\n')
+      ++end;
+    if (end > p)
+      chunks.push_back(Chunk{p, end, 0, 0});
+    p = end;
+  }
+  return chunks;
+}
+
+// Calls fn(lineBegin, lineEnd) for every non-empty line of the chunk.
+template<typename F>
+void forEachLine(Chunk const &chunk, F fn) {
+  const char *p = chunk.begin;
+  while (p < chunk.end) {
+    const char *eol = static_cast<const char *>(std::memchr(p, '\n', chunk.end - p));
+    if (!eol)
+      eol = chunk.end;
+    const char *end = eol;
+    if (end > p && end[-1] == '\r')
+      --end;
+    if (end > p)
+      fn(p, end);
+    p = eol + 1;
+  }
+}
+
+// Whether a token reads as a number the way mlpack's loader reads it
+// (operator>> consuming the whole token). Hex, inf and nan are not numbers there.
+bool parseNumber(CsvField field, double &value) {
+  if (field.second == 0 || field.second >= 64)
+    return false;
+  for (size_t i = 0; i < field.second; ++i) {
+    const char c = field.first[i];
+    if (!((c >= '0' && c <= '9') || c == '.' || c == '-' || c == '+' || c == 'e' || c == 'E'))
+      return false;
+  }
+  char buffer[64];
+  std::memcpy(buffer, field.first, field.second);
+  buffer[field.second] = '\0';
+  char *end;
+  value = std::strtod(buffer, &end);
+  return end == buffer + field.second;
+}
+
+// Counts the rows of every chunk and assigns their offsets in the matrix.
+// Returns the number of columns, which must be the same on every row.
+size_t countRows(std::vector<Chunk> &chunks, size_t threads) {
+  std::vector<size_t> columns(chunks.size(), 0);
+  parallelFor(chunks.size(), 1, [&](size_t, size_t begin, size_t end) {
+    std::vector<CsvField> fields;
+    for (size_t c = begin; c < end; ++c) {
+      forEachLine(chunks[c], [&](const char *line, const char *lineEnd) {
+        splitCsvLine(line, lineEnd, fields);
+        if (columns[c] == 0)
+          columns[c] = fields.size();
+        else if (columns[c] != fields.size())
+          throw std::runtime_error("Rows have different numbers of columns");
+        ++chunks[c].rows;
+      });
+    }
+  }, threads);
+
+  size_t rows = 0;
+  size_t cols = 0;
+  for (size_t c = 0; c < chunks.size(); ++c) {
+    chunks[c].firstRow = rows;
+    rows += chunks[c].rows;
+    if (cols == 0)
+      cols = columns[c];
+    else if (columns[c] != 0 && columns[c] != cols)
+      throw std::runtime_error("Rows have different numbers of columns");
+  }
+  return cols;
+}
+
+} // namespace
+
+void ParallelCsvReader::Load(
+    std::string const &path,
+    arma::mat &matrix,
+    data::DatasetInfo &info,
+    size_t threads) {
+  threads = threads == 0 ? defaultThreadCount() : threads;
+  MappedFile file(path);
+  std::vector<Chunk> chunks = splitChunks(file, threads * 4);
+  const size_t cols = countRows(chunks, threads);
+
+  // Pass 1: a column is categorical if any of its tokens is not a number.
+  std::vector<std::vector<char>> chunkCategorical(chunks.size(), std::vector<char>(cols, 0));
+  parallelFor(chunks.size(), 1, [&](size_t, size_t begin, size_t end) {
+    std::vector<CsvField> fields;
+    double value;
+    for (size_t c = begin; c < end; ++c) {
+      std::vector<char> &categorical = chunkCategorical[c];
+      forEachLine(chunks[c], [&](const char *line, const char *lineEnd) {
+        splitCsvLine(line, lineEnd, fields);
+        for (size_t col = 0; col < cols; ++col) {
+          if (!categorical[col] && !parseNumber(trimCsvField(fields[col]), value))
+            categorical[col] = 1;
+        }
+      });
+    }
+  }, threads);
+
+  std::vector<char> categorical(cols, 0);
+  for (auto const &chunk : chunkCategorical)
+    for (size_t col = 0; col < cols; ++col)
+      categorical[col] |= chunk[col];
+
+  // Pass 2: distinct categories of each chunk in order of first appearance.
+  std::vector<std::vector<std::vector<std::string>>> chunkCategories(
+      chunks.size(), std::vector<std::vector<std::string>>(cols));
+  parallelFor(chunks.size(), 1, [&](size_t, size_t begin, size_t end) {
+    std::vector<CsvField> fields;
+    for (size_t c = begin; c < end; ++c) {
+      std::vector<std::unordered_set<std::string>> seen(cols);
+      forEachLine(chunks[c], [&](const char *line, const char *lineEnd) {
+        splitCsvLine(line, lineEnd, fields);
+        for (size_t col = 0; col < cols; ++col) {
+          if (!categorical[col])
+            continue;
+          CsvField field = trimCsvField(fields[col]);
+          std::string token(field.first, field.second);
+          if (seen[col].insert(token).second)
+            chunkCategories[c][col].push_back(token);
+        }
+      });
+    }
+  }, threads);
+
+  // Merging in chunk order reproduces the sequential first-appearance order.
+  info = data::DatasetInfo(cols);
+  for (size_t col = 0; col < cols; ++col) {
+    if (!categorical[col])
+      continue;
+    info.Type(col) = data::Datatype::categorical;
+    for (auto const &categories : chunkCategories)
+      for (std::string const &token : categories[col])
+        info.MapString<double>(token, col);
+  }
+
+  // Pass 3: encode into the matrix.
+  CategoricalEncoder encoder(info);
+  size_t rows = 0;
+  for (Chunk const &chunk : chunks)
+    rows += chunk.rows;
+  matrix.set_size(cols, rows);
+
+  parallelFor(chunks.size(), 1, [&](size_t, size_t begin, size_t end) {
+    std::vector<CsvField> fields;
+    for (size_t c = begin; c < end; ++c) {
+      size_t row = chunks[c].firstRow;
+      forEachLine(chunks[c], [&](const char *line, const char *lineEnd) {
+        splitCsvLine(line, lineEnd, fields);
+        double *out = matrix.colptr(row++);
+        for (size_t col = 0; col < cols; ++col) {
+          CsvField field = trimCsvField(fields[col]);
+          out[col] = encoder.Encode(col, field.first, field.second);
+        }
+      });
+    }
+  }, threads);
+}
+
+void ParallelCsvReader::Load(
+    std::string const &path,
+    arma::mat &matrix,
+    CategoricalEncoder const &encoder,
+    size_t threads) {
+  threads = threads == 0 ? defaultThreadCount() : threads;
+  MappedFile file(path);
+  std::vector<Chunk> chunks = splitChunks(file, threads * 4);
+  const size_t cols = countRows(chunks, threads);
+  if (cols < encoder.Dimensionality())
+    throw std::runtime_error(path + " has fewer columns than the encoder");
+
+  size_t rows = 0;
+  for (Chunk const &chunk : chunks)
+    rows += chunk.rows;
+  const size_t dims = encoder.Dimensionality();
+  matrix.set_size(dims, rows);
+
+  parallelFor(chunks.size(), 1, [&](size_t, size_t begin, size_t end) {
+    std::vector<CsvField> fields;
+    for (size_t c = begin; c < end; ++c) {
+      size_t row = chunks[c].firstRow;
+      forEachLine(chunks[c], [&](const char *line, const char *lineEnd) {
+        splitCsvLine(line, lineEnd, fields);
+        double *out = matrix.colptr(row++);
+        for (size_t dim = 0; dim < dims; ++dim) {
+          CsvField field = trimCsvField(fields[dim]);
+          out[dim] = encoder.Encode(dim, field.first, field.second);
+        }
+      });
+    }
+  }, threads);
+}
@@ -0,0 +1,39 @@
+#ifndef MLPACK_PROJECT_PARALLEL_CSV_READER_H
+#define MLPACK_PROJECT_PARALLEL_CSV_READER_H
+
+#include <string>
+#include <mlpack.hpp>
+#include "../encoder/CategoricalEncoder.h"
+
+using namespace mlpack;
+
+// Multi-threaded replacement for data::Load on CSV files.
+//
+// The file is memory-mapped and split at line boundaries into one chunk per
+// task. Threads parse their chunks straight into a preallocated matrix with one
+// column per row, as data::Load lays it out. Building the dictionaries takes
+// two extra passes: one finds the columns that are not entirely numeric, and
+// one collects their categories in order of first appearance. The categories
+// are merged in file order, so each string gets the same code it would get
+// from a sequential data::Load.
+class ParallelCsvReader {
+public:
+  // Same result as data::Load(path, matrix, info) for a headerless CSV.
+  // Throws std::runtime_error if the file cannot be read or rows are ragged.
+  static void Load(
+      std::string const &path,
+      arma::mat &matrix,
+      data::DatasetInfo &info,
+      size_t threads = 0);
+
+  // Encodes the file with existing dictionaries, e.g. a scoring input.
+  // The encoder's unknown category policy applies; with Reject the first
+  // unknown value throws std::runtime_error.
+  static void Load(
+      std::string const &path,
+      arma::mat &matrix,
+      CategoricalEncoder const &encoder,
+      size_t threads = 0);
+};
+
+#endif // MLPACK_PROJECT_PARALLEL_CSV_READER_H
@@ -0,0 +1,46 @@
+#include "TrainingData.h"
+#include "ParallelCsvReader.h"
+
+TrainingData::TrainingData(std::string const &path, data::MinMaxScaler &scalar)
+    : path(path), scalar(scalar) {}
+
+void TrainingData::load() {
+  std::call_once(loaded, [this]() {
+    ParallelCsvReader::Load(path, dataset, info);
+    generator.reset(new ModelGenerator(dataset));
+
+    dataX = dataset.submat(0, 0, dataset.n_rows - 2, dataset.n_cols - 1);
+    dataY = dataset.row(dataset.n_rows - 1);
+    scalar.Transform(dataX, scaledX);
+  });
+}
+
+data::DatasetInfo const &TrainingData::Info() {
+  load();
+  return info;
+}
+
+arma::mat const &TrainingData::X() {
+  load();
+  return dataX;
+}
+
+arma::mat const &TrainingData::Y() {
+  load();
+  return dataY;
+}
+
+arma::mat const &TrainingData::ScaledX() {
+  load();
+  return scaledX;
+}
+
+ModelGenerator &TrainingData::Generator() {
+  load();
+  return *generator;
+}
+
+void TrainingData::SaveInfo(std::string const &infoPath) {
+  load();
+  data::Save(infoPath, "info", info, true);
+}
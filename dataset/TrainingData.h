@@ -0,0 +1,44 @@
+#ifndef MLPACK_PROJECT_TRAINING_DATA_H
+#define MLPACK_PROJECT_TRAINING_DATA_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <mlpack.hpp>
+#include "../generator/ModelGenerator.h"
+
+using namespace mlpack;
+
+// The training CSV and everything derived from it: the encoder dictionaries,
+// the feature/label split, the scaled features and the model generator.
+// Nothing is read until one of the accessors is first called, so a server
+// that only predicts never pays for it.
+class TrainingData {
+private:
+  std::string path;
+  data::MinMaxScaler &scalar;
+
+  std::once_flag loaded;
+  arma::mat dataset;
+  data::DatasetInfo info;
+  arma::mat dataX;
+  arma::mat dataY;
+  arma::mat scaledX;
+  std::unique_ptr<ModelGenerator> generator;
+
+  void load();
+
+public:
+  TrainingData(std::string const &path, data::MinMaxScaler &scalar);
+
+  data::DatasetInfo const &Info();
+  arma::mat const &X();
+  arma::mat const &Y();
+  arma::mat const &ScaledX();
+  ModelGenerator &Generator();
+
+  // Saves the encoder dictionaries so a serving-only server can start without the CSV.
+  void SaveInfo(std::string const &infoPath);
+};
+
+#endif // MLPACK_PROJECT_TRAINING_DATA_H
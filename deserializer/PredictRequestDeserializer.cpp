@@ -1,20 +1,46 @@
 #include "PredictRequestDeserializer.h"
 
+#include <iomanip>
+#include <sstream>
+
 PredictRequestDeserializer::PredictRequestDeserializer(
       data::DatasetInfo const &infoPtr,
-      std::vector<std::string> const &dimensionToDataFieldPtr): info(infoPtr),dimensionToDataField(dimensionToDataFieldPtr){}
+      std::vector<std::string> const &dimensionToDataFieldPtr,
+      UnknownCategoryPolicy policy,
+      double sentinel): encoder(infoPtr, policy, sentinel),dimensionToDataField(dimensionToDataFieldPtr),requests(0){}
+
+void PredictRequestDeserializer::convertRequestBodyToInput(crow::json::rvalue const &body, arma::colvec &input) {
+  if (input.n_elem != dimensionToDataField.size())
+    throw std::runtime_error("input size does not match the number of fields");
+  convertRequestBodyToInput(body, input.memptr());
+}
 
-void PredictRequestDeserializer::convertRequestBodyToInput(crow::json::rvalue &body, arma::colvec &input) {
-  for (size_t i = 0; i < input.size(); ++i) {
-    auto field = body[dimensionToDataField[i]];
-    std::string ss;
+void PredictRequestDeserializer::convertRequestBodyToInput(crow::json::rvalue const &body, double *input) {
+  requests.fetch_add(1, std::memory_order_relaxed);
+  for (size_t i = 0; i < dimensionToDataField.size(); ++i) {
+    auto &field = body[dimensionToDataField[i]];
     if (field.t() == crow::json::type::String) {
-      ss = field.s();   // If you don't do this, it'll return "abc" with the quotes
+      auto s = field.s();   // Points into the request body; no copy is made
+      input[i] = encoder.Encode(i, s.begin(), s.size());
+    } else if (field.t() == crow::json::type::Number) {
+      input[i] = encoder.EncodeNumber(i, field.d());
     } else {
-      std::ostringstream os;
-      os << field;
-      ss = os.str();
+      throw std::runtime_error("unsupported field type");
     }
-    input(i) = info.MapString<double>(ss, i);
   }
 }
+
+std::string PredictRequestDeserializer::UnknownValueReport() const {
+  const uint64_t total = requests.load();
+  std::ostringstream out;
+  out << std::left << std::setw(18) << "field"
+    << std::right << std::setw(10) << "unknown" << std::setw(10) << "rate" << '\n';
+  for (size_t i = 0; i < dimensionToDataField.size(); ++i) {
+    const uint64_t unknown = encoder.UnknownCount(i);
+    out << std::left << std::setw(18) << dimensionToDataField[i]
+      << std::right << std::setw(10) << unknown
+      << std::setw(10) << std::setprecision(3) << (total ? (double)unknown / total : 0.0)
+      << '\n';
+  }
+  return out.str();
+}
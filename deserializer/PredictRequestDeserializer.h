@@ -1,22 +1,33 @@
 #ifndef MLPACK_PROJECT_PREDICT_REQUEST_DESERIALIZER_H
 #define MLPACK_PROJECT_PREDICT_REQUEST_DESERIALIZER_H
 
+#include <atomic>
 #include <vector>
 #include "../crow_all.h"
 #include <mlpack.hpp>
+#include "../encoder/CategoricalEncoder.h"
 
 using namespace mlpack;
 
 class PredictRequestDeserializer {
 private:
-    data::DatasetInfo info;
+    CategoricalEncoder encoder;
     std::vector<std::string> dimensionToDataField;
+    std::atomic<uint64_t> requests;
 public:
     PredictRequestDeserializer(
       data::DatasetInfo const &infoPtr,
-      std::vector<std::string> const &dimensionToDataFieldPtr);
+      std::vector<std::string> const &dimensionToDataFieldPtr,
+      UnknownCategoryPolicy policy = UnknownCategoryPolicy::Reject,
+      double sentinel = -1);
 
-    void convertRequestBodyToInput(crow::json::rvalue &body, arma::colvec &input);
-   
+    void convertRequestBodyToInput(crow::json::rvalue const &body, arma::colvec &input);
+    // Writes one value per field to input, which must hold that many.
+    void convertRequestBodyToInput(crow::json::rvalue const &body, double *input);
+
+    CategoricalEncoder const &Encoder() const { return encoder; }
+
+    // Unknown values per field and their rate over all requests.
+    std::string UnknownValueReport() const;
 };
 #endif // MLPACK_PROJECT_PREDICT_REQUEST_DESERIALIZER_H
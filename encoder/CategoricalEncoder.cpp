@@ -0,0 +1,127 @@
+#include "CategoricalEncoder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Above this many categories Encode() switches from a scan to a binary search.
+const size_t LINEAR_SCAN_LIMIT = 8;
+
+int compareName(std::string const &name, const char *text, size_t size) {
+  int cmp = std::memcmp(name.data(), text, std::min(name.size(), size));
+  if (cmp != 0)
+    return cmp;
+  return name.size() < size ? -1 : (name.size() > size ? 1 : 0);
+}
+
+} // namespace
+
+CategoricalEncoder::CategoricalEncoder(
+    data::DatasetInfo const &info,
+    UnknownCategoryPolicy policy,
+    double sentinel)
+    : dimensions(info.Dimensionality()),
+      policy(policy),
+      sentinel(sentinel),
+      unknownCounts(new std::atomic<uint64_t>[info.Dimensionality()]) {
+
+  for (size_t i = 0; i < dimensions.size(); ++i) {
+    unknownCounts[i] = 0;
+    dimensions[i].categorical = info.Type(i) == data::Datatype::categorical;
+    if (!dimensions[i].categorical)
+      continue;
+
+    // DatasetInfo maps the n distinct strings of a dimension to 0 .. n-1.
+    // Stored in code order, so CategoryName() is a plain index.
+    for (size_t code = 0; code < info.NumMappings(i); ++code)
+      dimensions[i].categories.push_back(Category{info.UnmapString(code, i), (double)code});
+
+    std::vector<Category> const &categories = dimensions[i].categories;
+    if (categories.size() > LINEAR_SCAN_LIMIT) {
+      std::vector<size_t> &byName = dimensions[i].byName;
+      for (size_t c = 0; c < categories.size(); ++c)
+        byName.push_back(c);
+      std::sort(byName.begin(), byName.end(), [&](size_t a, size_t b) {
+        return categories[a].name < categories[b].name;
+      });
+    }
+  }
+}
+
+double CategoricalEncoder::unknown(size_t dimension) const {
+  ++unknownCounts[dimension];
+  switch (policy) {
+    case UnknownCategoryPolicy::Sentinel:
+      return sentinel;
+    case UnknownCategoryPolicy::Count:
+      return (double)dimensions[dimension].categories.size();
+    case UnknownCategoryPolicy::Reject:
+    default:
+      throw std::runtime_error("unknown category");
+  }
+}
+
+double CategoricalEncoder::Encode(size_t dimension, const char *text, size_t size) const {
+  Dimension const &dim = dimensions[dimension];
+
+  if (dim.categorical) {
+    if (dim.byName.empty()) {
+      // Most dimensions have a handful of categories, where a linear scan
+      // beats hashing the input.
+      for (Category const &category : dim.categories) {
+        if (category.name.size() == size && std::memcmp(category.name.data(), text, size) == 0)
+          return category.code;
+      }
+    } else {
+      auto it = std::lower_bound(dim.byName.begin(), dim.byName.end(), 0,
+          [&](size_t c, int) { return compareName(dim.categories[c].name, text, size) < 0; });
+      if (it != dim.byName.end() && compareName(dim.categories[*it].name, text, size) == 0)
+        return dim.categories[*it].code;
+    }
+    return unknown(dimension);
+  }
+
+  // Numeric dimension given as text. Copy into a terminated buffer for strtod.
+  char buffer[64];
+  if (size == 0 || size >= sizeof(buffer)) {
+    ++unknownCounts[dimension];
+    throw std::runtime_error("invalid number");
+  }
+  std::memcpy(buffer, text, size);
+  buffer[size] = '\0';
+  char *end;
+  double value = std::strtod(buffer, &end);
+  if (end != buffer + size) {
+    ++unknownCounts[dimension];
+    throw std::runtime_error("invalid number");
+  }
+  return value;
+}
+
+double CategoricalEncoder::EncodeNumber(size_t dimension, double value) const {
+  if (!dimensions[dimension].categorical)
+    return value;
+
+  // A categorical field sent as a number, e.g. 1 instead of "1".
+  char buffer[32];
+  int size = std::snprintf(buffer, sizeof(buffer), "%g", value);
+  return Encode(dimension, buffer, (size_t)size);
+}
+
+std::string const &CategoricalEncoder::CategoryName(size_t dimension, size_t code) const {
+  return dimensions[dimension].categories.at(code).name;
+}
+
+UnknownCategoryPolicy CategoricalEncoder::ParsePolicy(std::string const &name) {
+  if (name == "reject")
+    return UnknownCategoryPolicy::Reject;
+  if (name == "sentinel")
+    return UnknownCategoryPolicy::Sentinel;
+  if (name == "count")
+    return UnknownCategoryPolicy::Count;
+  throw std::invalid_argument("Unknown category policy: " + name);
+}
@@ -0,0 +1,75 @@
+#ifndef MLPACK_PROJECT_CATEGORICAL_ENCODER_H
+#define MLPACK_PROJECT_CATEGORICAL_ENCODER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <mlpack.hpp>
+
+using namespace mlpack;
+
+// What to do with a category that was not seen in the training data.
+// Every policy counts the occurrence.
+enum class UnknownCategoryPolicy {
+  Reject,    // Throw, so the request is answered with 400.
+  Sentinel,  // Encode as a fixed sentinel value.
+  Count      // Encode as the next unused code, like DatasetInfo::MapString
+             // would have, but without adding it to the dictionary.
+};
+
+// Read-only snapshot of the mappings in a data::DatasetInfo.
+// DatasetInfo::MapString inserts every unseen string it is given, so calling it
+// from concurrent request handlers races and grows the dictionary without bound.
+// This encoder is built once at load time and never modified afterwards, so
+// Encode() is safe to call from any thread without locking and does not
+// allocate for known categories or numeric values.
+class CategoricalEncoder {
+private:
+  struct Category {
+    std::string name;
+    double code;
+  };
+
+  struct Dimension {
+    bool categorical;
+    std::vector<Category> categories;
+    // Positions in `categories` sorted by name; only built for dimensions with
+    // too many categories for a linear scan.
+    std::vector<size_t> byName;
+  };
+
+  std::vector<Dimension> dimensions;
+  UnknownCategoryPolicy policy;
+  double sentinel;
+  std::unique_ptr<std::atomic<uint64_t>[]> unknownCounts;
+
+  double unknown(size_t dimension) const;
+
+public:
+  CategoricalEncoder(
+      data::DatasetInfo const &info,
+      UnknownCategoryPolicy policy = UnknownCategoryPolicy::Reject,
+      double sentinel = -1);
+
+  // Encodes the text of a field. Throws std::runtime_error if the value is
+  // rejected.
+  double Encode(size_t dimension, const char *text, size_t size) const;
+
+  // Encodes a field that arrived as a number.
+  double EncodeNumber(size_t dimension, double value) const;
+
+  size_t Dimensionality() const { return dimensions.size(); }
+  bool IsCategorical(size_t dimension) const { return dimensions[dimension].categorical; }
+  size_t NumCategories(size_t dimension) const { return dimensions[dimension].categories.size(); }
+
+  // Name of the category encoded as `code` in a categorical dimension.
+  std::string const &CategoryName(size_t dimension, size_t code) const;
+
+  uint64_t UnknownCount(size_t dimension) const { return unknownCounts[dimension].load(); }
+
+  static UnknownCategoryPolicy ParsePolicy(std::string const &name);
+};
+
+#endif // MLPACK_PROJECT_CATEGORICAL_ENCODER_H
@@ -0,0 +1,144 @@
+#include "Bootstrap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include "../util/Parallel.h"
+#include "../util/Random.h"
+
+namespace {
+
+// Poisson(1) quantile function sampled at 2^16 points. Each 64-bit hash
+// yields four 16-bit uniforms, i.e. weights for four rows.
+struct PoissonTable {
+  unsigned char weight[1 << 16];
+  PoissonTable() {
+    double p = std::exp(-1.0), cdf = p;
+    unsigned k = 0;
+    for (size_t u = 0; u < (1 << 16); ++u) {
+      while ((u + 0.5) / (1 << 16) >= cdf) {
+        p /= ++k;
+        cdf += p;
+      }
+      weight[u] = k;
+    }
+  }
+};
+
+const PoissonTable POISSON;
+
+inline uint64_t weightBits(uint64_t stream, uint64_t block) {
+  return mix(stream + block * 0x9e3779b97f4a7c15ULL);
+}
+
+double ratio(double numerator, double denominator) {
+  return denominator > 0 ? numerator / denominator : 0;
+}
+
+// Linear interpolation between order statistics.
+double quantile(std::vector<double> const& sorted, double q) {
+  if (sorted.empty())
+    return 0;
+  const double position = q * (sorted.size() - 1);
+  const size_t below = (size_t)position;
+  const size_t above = std::min(below + 1, sorted.size() - 1);
+  return sorted[below] + (position - below) * (sorted[above] - sorted[below]);
+}
+
+const char* METRIC_NAMES[] = {"accuracy", "precision", "recall", "f1-score", "ROC-AUC"};
+
+} // namespace
+
+Bootstrap::Bootstrap(const arma::rowvec& scores, const arma::rowvec& labels) {
+  std::vector<size_t> order;
+  order.reserve(scores.n_elem);
+  for (size_t i = 0; i < scores.n_elem; ++i) {
+    if (!std::isnan(scores(i)))
+      order.push_back(i);
+  }
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return scores(a) < scores(b); });
+
+  const size_t n = order.size();
+  positive.resize(n);
+  predicted.resize(n);
+  lastOfTie.resize(n);
+  for (size_t p = 0; p < n; ++p) {
+    positive[p] = labels(order[p]) >= 0.5;
+    predicted[p] = scores(order[p]) >= 0.5;
+    lastOfTie[p] = p + 1 == n || scores(order[p + 1]) != scores(order[p]);
+  }
+}
+
+void Bootstrap::evaluate(uint64_t stream, bool weighted, double* metrics) const {
+  double tp = 0, fp = 0, tn = 0, fn = 0;
+  double tiePositives = 0, tieNegatives = 0, negativesBelow = 0, pairs = 0;
+  const size_t n = positive.size();
+  uint64_t bits = 0;
+  for (size_t p = 0; p < n; ++p) {
+    double w = 1;
+    if (weighted) {
+      if (p % 4 == 0)
+        bits = weightBits(stream, p / 4);
+      w = POISSON.weight[bits & 0xffff];
+      bits >>= 16;
+    }
+    if (positive[p]) {
+      tiePositives += w;
+      (predicted[p] ? tp : fn) += w;
+    } else {
+      tieNegatives += w;
+      (predicted[p] ? fp : tn) += w;
+    }
+    if (lastOfTie[p]) {
+      pairs += tiePositives * (negativesBelow + 0.5 * tieNegatives);
+      negativesBelow += tieNegatives;
+      tiePositives = tieNegatives = 0;
+    }
+  }
+
+  const double precision = ratio(tp, tp + fp);
+  const double recall = ratio(tp, tp + fn);
+  metrics[ACCURACY] = ratio(tp + tn, tp + fp + tn + fn);
+  metrics[PRECISION] = precision;
+  metrics[RECALL] = recall;
+  metrics[F1] = ratio(2 * precision * recall, precision + recall);
+  metrics[AUC] = ratio(pairs, (tp + fn) * (fp + tn));
+}
+
+std::vector<Bootstrap::Interval> Bootstrap::Run(size_t resamples, double confidence, uint64_t seed, size_t threads) const {
+  std::vector<double> values(resamples * METRICS);
+  parallelFor(resamples, 1, [&](size_t, size_t begin, size_t end) {
+    for (size_t b = begin; b < end; ++b)
+      evaluate(mix(seed ^ mix(b + 1)), true, &values[b * METRICS]);
+  }, threads);
+
+  double full[METRICS];
+  evaluate(0, false, full);
+
+  const double alpha = (1 - confidence) / 2;
+  std::vector<Interval> intervals;
+  std::vector<double> metric(resamples);
+  for (size_t m = 0; m < METRICS; ++m) {
+    for (size_t b = 0; b < resamples; ++b)
+      metric[b] = values[b * METRICS + m];
+    std::sort(metric.begin(), metric.end());
+    intervals.push_back({METRIC_NAMES[m], full[m], quantile(metric, alpha), quantile(metric, 1 - alpha)});
+  }
+  return intervals;
+}
+
+std::string Bootstrap::Report(std::vector<Interval> const& intervals, size_t resamples, double confidence) {
+  std::ostringstream out;
+  out << resamples << " bootstrap resamples, " << std::setprecision(3) << confidence * 100
+    << "% percentile intervals" << '\n' << '\n'
+    << std::left << std::setw(12) << "metric" << std::right
+    << std::setw(12) << "estimate" << std::setw(12) << "lower" << std::setw(12) << "upper" << '\n';
+  for (Interval const& interval : intervals) {
+    out << std::left << std::setw(12) << interval.metric << std::right << std::setprecision(4)
+      << std::setw(12) << interval.estimate
+      << std::setw(12) << interval.lower
+      << std::setw(12) << interval.upper << '\n';
+  }
+  return out.str();
+}
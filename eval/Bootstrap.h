@@ -0,0 +1,49 @@
+#ifndef MLPACK_PROJECT_BOOTSTRAP_H
+#define MLPACK_PROJECT_BOOTSTRAP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mlpack.hpp>
+
+// Percentile bootstrap confidence intervals for accuracy, precision, recall,
+// F1 and ROC-AUC of a model's scores.
+//
+// A resample is drawn as a Poisson(1) weight per row instead of a copy of the
+// data. Weights come from a counter-based generator keyed by the seed, the
+// resample and the row (see util/Random.h). Each 64-bit draw is split into
+// four 16-bit uniforms mapped through a Poisson quantile table.
+// The scores are sorted once; each resample is then one pass over the rows
+// that accumulates weighted confusion counts and the weighted AUC together.
+// Resamples are handed to threads from a shared counter.
+class Bootstrap {
+public:
+  struct Interval {
+    std::string metric;
+    double estimate;  // On the full data
+    double lower;
+    double upper;
+  };
+
+  // A row is predicted positive when its score is at least 0.5; labels >= 0.5
+  // are positive. NaN scores are skipped.
+  Bootstrap(const arma::rowvec& scores, const arma::rowvec& labels);
+
+  std::vector<Interval> Run(size_t resamples, double confidence, uint64_t seed = 42, size_t threads = 0) const;
+
+  static std::string Report(std::vector<Interval> const& intervals, size_t resamples, double confidence);
+
+private:
+  enum { ACCURACY, PRECISION, RECALL, F1, AUC, METRICS };
+
+  // Rows in ascending score order.
+  std::vector<char> positive;
+  std::vector<char> predicted;
+  std::vector<char> lastOfTie;  // Next row has a different score
+
+  // All metrics for the resample drawn from stream, or for the full data
+  // when weighted is false.
+  void evaluate(uint64_t stream, bool weighted, double* metrics) const;
+};
+
+#endif // MLPACK_PROJECT_BOOTSTRAP_H
@@ -0,0 +1,166 @@
+#include "GroupedEvaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include "RankMetrics.h"
+#include "../util/Parallel.h"
+
+namespace {
+
+const size_t GRAIN = 1 << 14;
+
+// Counters per group: true/false positives/negatives, then the score
+// histogram of positives and of negatives.
+enum { TP, FP, TN, FN, COUNTS };
+
+double ratio(double numerator, double denominator) {
+  return denominator > 0 ? numerator / denominator : 0;
+}
+
+} // namespace
+
+const size_t GroupedEvaluator::MAX_GROUPS;
+const size_t GroupedEvaluator::MAX_NUMERIC_LEVELS;
+const size_t GroupedEvaluator::SCORE_BINS;
+
+GroupedEvaluator::GroupedEvaluator(CategoricalEncoder const &encoder, std::vector<std::string> const &fieldNames)
+    : encoder(encoder), fieldNames(fieldNames) {}
+
+std::vector<size_t> GroupedEvaluator::ParseFields(std::string const &by) const {
+  std::vector<size_t> fields;
+  std::istringstream in(by);
+  std::string name;
+  while (std::getline(in, name, ',')) {
+    auto it = std::find(fieldNames.begin(), fieldNames.end(), name);
+    if (it == fieldNames.end())
+      throw std::invalid_argument("Unknown field: " + name);
+    fields.push_back(it - fieldNames.begin());
+  }
+  if (fields.empty())
+    throw std::invalid_argument("No fields to group by");
+  return fields;
+}
+
+size_t GroupedEvaluator::levels(const arma::mat &data, size_t field) const {
+  if (encoder.IsCategorical(field))
+    return encoder.NumCategories(field);
+
+  double highest = 0;
+  for (size_t i = 0; i < data.n_cols; ++i) {
+    const double value = data(field, i);
+    if (value < 0 || value >= MAX_NUMERIC_LEVELS || value != std::floor(value))
+      throw std::invalid_argument("Cannot group by " + fieldNames[field] + ": values are not small integers");
+    highest = std::max(highest, value);
+  }
+  return (size_t)highest + 1;
+}
+
+std::string GroupedEvaluator::levelName(size_t field, size_t level) const {
+  if (encoder.IsCategorical(field))
+    return encoder.CategoryName(field, level);
+  return std::to_string(level);
+}
+
+std::string GroupedEvaluator::Report(const arma::mat &data,
+                                     const arma::rowvec &scores,
+                                     const arma::rowvec &labels,
+                                     std::vector<size_t> const &fields) const {
+  // Groups are numbered in mixed radix over the fields' levels.
+  std::vector<size_t> radix;
+  size_t groups = 1;
+  for (size_t field : fields) {
+    radix.push_back(levels(data, field));
+    groups *= radix.back();
+    if (groups > MAX_GROUPS)
+      throw std::invalid_argument("Too many segments");
+  }
+
+  double low = std::numeric_limits<double>::infinity();
+  double high = -low;
+  for (double score : scores) {
+    if (std::isfinite(score)) {
+      low = std::min(low, score);
+      high = std::max(high, score);
+    }
+  }
+  const double width = high > low ? (high - low) / SCORE_BINS : 1;
+
+  const size_t stride = COUNTS + 2 * SCORE_BINS;
+  const size_t workers = defaultThreadCount();
+  std::vector<std::vector<uint64_t>> counts(workers, std::vector<uint64_t>(groups * stride, 0));
+
+  parallelFor(data.n_cols, GRAIN, [&](size_t worker, size_t begin, size_t end) {
+    uint64_t *local = counts[worker].data();
+    for (size_t i = begin; i < end; ++i) {
+      size_t group = 0;
+      bool known = true;
+      for (size_t f = 0; f < fields.size(); ++f) {
+        const double value = data(fields[f], i);
+        // Skips rows whose category is outside the dictionary.
+        if (!(value >= 0 && value < radix[f])) {
+          known = false;
+          break;
+        }
+        group = group * radix[f] + (size_t)value;
+      }
+      const double score = scores(i);
+      if (!known || std::isnan(score))
+        continue;
+
+      uint64_t *counters = local + group * stride;
+      const bool positive = labels(i) >= 0.5;
+      const bool predicted = score >= 0.5;
+      ++counters[positive ? (predicted ? TP : FN) : (predicted ? FP : TN)];
+      ++counters[COUNTS + (positive ? 0 : SCORE_BINS) + RankMetrics::Bin(score, low, width, SCORE_BINS)];
+    }
+  }, workers);
+
+  std::vector<uint64_t> total(groups * stride, 0);
+  for (std::vector<uint64_t> const &local : counts) {
+    for (size_t c = 0; c < total.size(); ++c)
+      total[c] += local[c];
+  }
+
+  std::string title;
+  for (size_t field : fields)
+    title += (title.empty() ? "" : ", ") + fieldNames[field];
+
+  std::ostringstream out;
+  out << std::left << std::setw(40) << title << std::right
+    << std::setw(10) << "support" << std::setw(10) << "def rate"
+    << std::setw(10) << "accuracy" << std::setw(11) << "precision"
+    << std::setw(10) << "recall" << std::setw(10) << "f1-score"
+    << std::setw(10) << "ROC-AUC" << '\n' << '\n';
+
+  for (size_t group = 0; group < groups; ++group) {
+    const uint64_t *counters = &total[group * stride];
+    const double tp = counters[TP], fp = counters[FP], tn = counters[TN], fn = counters[FN];
+    const double support = tp + fp + tn + fn;
+    if (support == 0)
+      continue;
+
+    std::string name;
+    for (size_t f = fields.size(), rest = group; f-- > 0; rest /= radix[f])
+      name = levelName(fields[f], rest % radix[f]) + (name.empty() ? "" : ", ") + name;
+
+    const double precision = ratio(tp, tp + fp);
+    const double recall = ratio(tp, tp + fn);
+    const RankMetrics rank = RankMetrics::FromHistogram(
+        counters + COUNTS, counters + COUNTS + SCORE_BINS, SCORE_BINS);
+
+    out << std::left << std::setw(40) << name << std::right << std::setprecision(3)
+      << std::setw(10) << (uint64_t)support
+      << std::setw(10) << ratio(tp + fn, support)
+      << std::setw(10) << ratio(tp + tn, support)
+      << std::setw(11) << precision
+      << std::setw(10) << recall
+      << std::setw(10) << ratio(2 * precision * recall, precision + recall)
+      << std::setw(10) << rank.auc
+      << '\n';
+  }
+  return out.str();
+}
@@ -0,0 +1,48 @@
+#ifndef MLPACK_PROJECT_GROUPED_EVALUATOR_H
+#define MLPACK_PROJECT_GROUPED_EVALUATOR_H
+
+#include <string>
+#include <vector>
+#include <mlpack.hpp>
+#include "../encoder/CategoricalEncoder.h"
+
+// Model performance per segment, e.g. per Contract or per Contract and gender.
+//
+// One parallel pass over the rows accumulates, for every combination of the
+// grouping fields' values, a confusion matrix and a histogram of scores per
+// class. Each thread has its own counters, merged at the end. Segments are
+// reported with support, default rate, accuracy, precision, recall, F1 and a
+// binned ROC-AUC.
+//
+// Categorical fields group by category. Numeric fields can be used when all
+// their values are small non-negative integers, such as SeniorCitizen.
+class GroupedEvaluator {
+public:
+  GroupedEvaluator(CategoricalEncoder const &encoder, std::vector<std::string> const &fieldNames);
+
+  // Resolves a comma separated list of field names.
+  // Throws std::invalid_argument for an unknown field.
+  std::vector<size_t> ParseFields(std::string const &by) const;
+
+  // data holds the encoded rows the scores were computed from. A row is
+  // predicted positive when its score is at least 0.5.
+  // Throws std::invalid_argument if a field cannot be grouped by or there
+  // would be too many segments.
+  std::string Report(const arma::mat &data,
+                     const arma::rowvec &scores,
+                     const arma::rowvec &labels,
+                     std::vector<size_t> const &fields) const;
+
+  static const size_t MAX_GROUPS = 4096;
+  static const size_t MAX_NUMERIC_LEVELS = 256;
+  static const size_t SCORE_BINS = 256;
+
+private:
+  CategoricalEncoder const &encoder;
+  std::vector<std::string> fieldNames;
+
+  size_t levels(const arma::mat &data, size_t field) const;
+  std::string levelName(size_t field, size_t level) const;
+};
+
+#endif // MLPACK_PROJECT_GROUPED_EVALUATOR_H
@@ -1,5 +1,9 @@
 #include "ModelEvaluator.h"
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 // Utility functions for evaluation metrics.
 double ModelEvaluator::ComputeAccuracy(const arma::Row<double>& yPreds, const arma::Row<double>& yTrue) {
   const double correct = arma::accu(yPreds == yTrue);
@@ -20,3 +24,103 @@ double ModelEvaluator::ComputeF1Score(const double truePos, const double falsePo
   return 2 * (prec * rec) / (prec + rec);
 }
 
+
+std::string ModelEvaluator::CompareScores(const arma::rowvec& reference, const arma::rowvec& candidate, const arma::rowvec& yTrue) {
+  const arma::rowvec refPreds = round(reference);
+  const arma::rowvec candPreds = round(candidate);
+  const arma::rowvec drift = arma::abs(candidate - reference);
+
+  std::ostringstream out;
+  out << std::setw(24) << std::left << "reference accuracy" << std::setprecision(4) << ComputeAccuracy(refPreds, yTrue) << '\n'
+    << std::setw(24) << "candidate accuracy" << ComputeAccuracy(candPreds, yTrue) << '\n'
+    << std::setw(24) << "decision agreement" << ComputeAccuracy(candPreds, refPreds) << '\n'
+    << std::setw(24) << "mean abs score drift" << arma::mean(drift) << '\n'
+    << std::setw(24) << "max abs score drift" << arma::max(drift) << '\n';
+  return out.str();
+}
+
+ModelEvaluator::CascadeBand ModelEvaluator::TuneCascadeBand(
+    const arma::rowvec& cheap,
+    const arma::rowvec& expensive,
+    const arma::rowvec& yTrue,
+    double maxAccuracyLoss) {
+  const size_t n = yTrue.n_elem;
+
+  // Escalating a row changes the number of correct decisions by gain:
+  // +1 if only the expensive model is right, -1 if only the cheap one is.
+  std::vector<std::pair<double, int>> below, above;
+  double cheapCorrect = 0, expensiveCorrect = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const bool cheapRight = (cheap(i) >= 0.5) == (yTrue(i) >= 0.5);
+    const bool expensiveRight = (expensive(i) >= 0.5) == (yTrue(i) >= 0.5);
+    cheapCorrect += cheapRight;
+    expensiveCorrect += expensiveRight;
+    const int gain = (int)expensiveRight - (int)cheapRight;
+    (cheap(i) < 0.5 ? below : above).emplace_back(cheap(i), gain);
+  }
+
+  // Widening the band escalates the rows nearest the cutoff first.
+  std::sort(below.begin(), below.end(), [](const std::pair<double, int>& a, const std::pair<double, int>& b) {
+    return a.first > b.first;
+  });
+  std::sort(above.begin(), above.end());
+
+  std::vector<double> belowGain(below.size() + 1, 0);
+  for (size_t i = 0; i < below.size(); ++i)
+    belowGain[i + 1] = belowGain[i] + below[i].second;
+  // Best gain reachable by escalating at most j rows above the cutoff; it
+  // never decreases, so the smallest j that is enough can be bisected.
+  std::vector<double> aboveBest(above.size() + 1, 0);
+  double aboveGain = 0;
+  for (size_t j = 0; j < above.size(); ++j) {
+    aboveGain += above[j].second;
+    aboveBest[j + 1] = std::max(aboveBest[j], aboveGain);
+  }
+
+  const double target = expensiveCorrect - maxAccuracyLoss * n;
+  size_t bestBelow = below.size(), bestAbove = above.size();
+  for (size_t i = 0; i <= below.size(); ++i) {
+    const double needed = target - cheapCorrect - belowGain[i];
+    auto it = std::lower_bound(aboveBest.begin(), aboveBest.end(), needed);
+    if (it == aboveBest.end())
+      continue;
+    const size_t j = it - aboveBest.begin();
+    if (i + j < bestBelow + bestAbove) {
+      bestBelow = i;
+      bestAbove = j;
+    }
+  }
+
+  CascadeBand band;
+  band.low = bestBelow == 0 ? 0.5 : below[bestBelow - 1].first;
+  band.high = bestAbove == 0 ? std::nextafter(0.5, 0.0) : above[bestAbove - 1].first;
+  if (bestBelow == below.size() && bestAbove == above.size()) {
+    band.low = -std::numeric_limits<double>::infinity();
+    band.high = std::numeric_limits<double>::infinity();
+  }
+
+  // Score the chosen band as served, ties at its edges included.
+  double escalated = 0, correct = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const bool escalate = cheap(i) >= band.low && cheap(i) <= band.high;
+    const double score = escalate ? expensive(i) : cheap(i);
+    escalated += escalate;
+    correct += (score >= 0.5) == (yTrue(i) >= 0.5);
+  }
+  band.escalationRate = n ? escalated / n : 0;
+  band.cascadeAccuracy = n ? correct / n : 0;
+  band.cheapAccuracy = n ? cheapCorrect / n : 0;
+  band.expensiveAccuracy = n ? expensiveCorrect / n : 0;
+  return band;
+}
+
+std::string ModelEvaluator::CascadeReport(const CascadeBand& band) {
+  std::ostringstream out;
+  out << std::setw(26) << std::left << "band low" << std::setprecision(6) << band.low << '\n'
+    << std::setw(26) << "band high" << band.high << '\n'
+    << std::setw(26) << "escalation rate" << std::setprecision(4) << band.escalationRate << '\n'
+    << std::setw(26) << "cascade accuracy" << band.cascadeAccuracy << '\n'
+    << std::setw(26) << "cheap model accuracy" << band.cheapAccuracy << '\n'
+    << std::setw(26) << "expensive model accuracy" << band.expensiveAccuracy << '\n';
+  return out.str();
+}
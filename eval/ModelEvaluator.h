@@ -9,6 +9,17 @@
 class ModelEvaluator {
   public:
 
+    // A band of cheap-model scores inside which a cascade defers to the
+    // expensive model, and how the cascade did on the tuning data.
+    struct CascadeBand {
+      double low;
+      double high;
+      double escalationRate;
+      double cascadeAccuracy;
+      double cheapAccuracy;
+      double expensiveAccuracy;
+    };
+
     // Utility functions for evaluation metrics.
     static double ComputeAccuracy(const arma::Row<double>& yPreds, const arma::Row<double>& yTrue);
 
@@ -18,6 +29,18 @@ class ModelEvaluator {
 
     static double ComputeF1Score(const double truePos, const double falsePos, const double falseNeg);
 
+    // Compares a candidate's scores with a reference model's on the same rows:
+    // accuracy of each at the 0.5 cutoff, how often their decisions agree and
+    // how far the scores drift.
+    static std::string CompareScores(const arma::rowvec& reference, const arma::rowvec& candidate, const arma::rowvec& yTrue);
+
+    // Finds the band around the 0.5 cutoff that escalates the fewest rows
+    // while keeping the cascade's accuracy within maxAccuracyLoss of the
+    // expensive model's. Scores are decided at 0.5, as in Eval.
+    static CascadeBand TuneCascadeBand(const arma::rowvec& cheap, const arma::rowvec& expensive, const arma::rowvec& yTrue, double maxAccuracyLoss);
+
+    static std::string CascadeReport(const CascadeBand& band);
+
     template<typename PredType, typename TrueType>
     static std::string ClassificationReport(const PredType& yPreds, const TrueType& yTrue) {
       TrueType uniqs = arma::unique(yTrue);
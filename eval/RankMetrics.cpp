@@ -0,0 +1,162 @@
+#include "RankMetrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <vector>
+#include "../util/Parallel.h"
+
+namespace {
+
+const size_t GRAIN = 1 << 16;
+
+// Accumulates groups of tied scores in ascending score order.
+class RankSweep {
+public:
+  RankSweep(double positives, double negatives)
+      : positives(positives), negatives(negatives),
+        positivesBelow(0), negativesBelow(0), pairs(0), maxGap(0) {}
+
+  void group(double groupPositives, double groupNegatives) {
+    // Each positive outranks every negative below it and ties with half of
+    // the negatives in its own group.
+    pairs += groupPositives * (negativesBelow + 0.5 * groupNegatives);
+    positivesBelow += groupPositives;
+    negativesBelow += groupNegatives;
+    if (positives > 0 && negatives > 0)
+      maxGap = std::max(maxGap, std::abs(negativesBelow / negatives - positivesBelow / positives));
+  }
+
+  RankMetrics result(bool approximate) const {
+    RankMetrics metrics;
+    metrics.positives = (size_t)positives;
+    metrics.negatives = (size_t)negatives;
+    metrics.approximate = approximate;
+    if (positives > 0 && negatives > 0) {
+      metrics.auc = pairs / (positives * negatives);
+      metrics.gini = 2 * metrics.auc - 1;
+      metrics.ks = maxGap;
+    }
+    return metrics;
+  }
+
+private:
+  double positives;
+  double negatives;
+  double positivesBelow;
+  double negativesBelow;
+  double pairs;
+  double maxGap;
+};
+
+typedef std::pair<double, bool> ScoredLabel;
+
+} // namespace
+
+RankMetrics RankMetrics::Exact(const arma::rowvec& scores, const arma::rowvec& labels, size_t threads) {
+  std::vector<ScoredLabel> rows;
+  rows.reserve(scores.n_elem);
+  for (size_t i = 0; i < scores.n_elem; ++i) {
+    if (!std::isnan(scores(i)))
+      rows.emplace_back(scores(i), labels(i) >= 0.5);
+  }
+  const size_t n = rows.size();
+
+  // Sort blocks in parallel, then merge neighbouring runs pairwise.
+  parallelFor(n, GRAIN, [&](size_t, size_t begin, size_t end) {
+    std::sort(rows.begin() + begin, rows.begin() + end);
+  }, threads);
+  std::vector<ScoredLabel> merged(n);
+  for (size_t width = GRAIN; width < n; width *= 2) {
+    parallelFor(n, 2 * width, [&](size_t, size_t begin, size_t end) {
+      const size_t middle = std::min(begin + width, end);
+      std::merge(rows.begin() + begin, rows.begin() + middle,
+                 rows.begin() + middle, rows.begin() + end,
+                 merged.begin() + begin);
+    }, threads);
+    rows.swap(merged);
+  }
+
+  size_t positives = 0;
+  for (ScoredLabel const &row : rows)
+    positives += row.second;
+
+  RankSweep sweep(positives, n - positives);
+  for (size_t i = 0; i < n;) {
+    double groupPositives = 0, groupNegatives = 0;
+    const double score = rows[i].first;
+    for (; i < n && rows[i].first == score; ++i)
+      (rows[i].second ? groupPositives : groupNegatives) += 1;
+    sweep.group(groupPositives, groupNegatives);
+  }
+  return sweep.result(false);
+}
+
+RankMetrics RankMetrics::Histogram(const arma::rowvec& scores, const arma::rowvec& labels,
+                                   double low, double high, size_t bins, size_t threads) {
+  bins = std::max<size_t>(1, bins);
+  const size_t workers = threads == 0 ? defaultThreadCount() : threads;
+  const double width = high > low ? (high - low) / bins : 1;
+
+  // Per worker: positives then negatives for every bin.
+  std::vector<std::vector<uint64_t>> counts(workers, std::vector<uint64_t>(2 * bins, 0));
+  parallelFor(scores.n_elem, GRAIN, [&](size_t worker, size_t begin, size_t end) {
+    uint64_t *positive = counts[worker].data();
+    uint64_t *negative = positive + bins;
+    for (size_t i = begin; i < end; ++i) {
+      const double score = scores(i);
+      if (std::isnan(score))
+        continue;
+      ++(labels(i) >= 0.5 ? positive : negative)[Bin(score, low, width, bins)];
+    }
+  }, workers);
+
+  std::vector<uint64_t> total(2 * bins, 0);
+  for (std::vector<uint64_t> const &local : counts) {
+    for (size_t b = 0; b < 2 * bins; ++b)
+      total[b] += local[b];
+  }
+
+  return FromHistogram(total.data(), total.data() + bins, bins);
+}
+
+RankMetrics RankMetrics::FromHistogram(const uint64_t* positives, const uint64_t* negatives, size_t bins) {
+  double totalPositives = 0, totalNegatives = 0;
+  for (size_t b = 0; b < bins; ++b) {
+    totalPositives += positives[b];
+    totalNegatives += negatives[b];
+  }
+
+  RankSweep sweep(totalPositives, totalNegatives);
+  for (size_t b = 0; b < bins; ++b)
+    sweep.group(positives[b], negatives[b]);
+  return sweep.result(true);
+}
+
+RankMetrics RankMetrics::Compute(const arma::rowvec& scores, const arma::rowvec& labels) {
+  if (scores.n_elem <= EXACT_LIMIT)
+    return Exact(scores, labels);
+
+  double low = std::numeric_limits<double>::infinity();
+  double high = -low;
+  for (double score : scores) {
+    if (std::isfinite(score)) {
+      low = std::min(low, score);
+      high = std::max(high, score);
+    }
+  }
+  if (low > high)
+    return RankMetrics();
+  return Histogram(scores, labels, low, high);
+}
+
+std::string RankMetrics::Report() const {
+  std::ostringstream out;
+  out << std::left << std::setprecision(4)
+    << std::setw(14) << "ROC-AUC" << auc << (approximate ? " (binned)" : "") << '\n'
+    << std::setw(14) << "Gini" << gini << '\n'
+    << std::setw(14) << "KS" << ks << '\n';
+  return out.str();
+}
@@ -0,0 +1,56 @@
+#ifndef MLPACK_PROJECT_RANK_METRICS_H
+#define MLPACK_PROJECT_RANK_METRICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <mlpack.hpp>
+
+// Threshold-free metrics of how well scores rank defaulters above
+// non-defaulters: ROC-AUC, Gini (2 * AUC - 1) and the Kolmogorov-Smirnov
+// statistic (the largest gap between the two classes' score distributions).
+//
+// Exact() sorts the scores once, in parallel, and handles tied scores as
+// half-ranks. Histogram() bins the scores in one streaming pass with a
+// histogram per thread, merged at the end; scores in the same bin count as
+// tied. Labels >= 0.5 are positive. NaN scores are skipped.
+class RankMetrics {
+public:
+  double auc = 0;
+  double gini = 0;
+  double ks = 0;
+  size_t positives = 0;
+  size_t negatives = 0;
+  bool approximate = false;
+
+  static RankMetrics Exact(const arma::rowvec& scores, const arma::rowvec& labels, size_t threads = 0);
+
+  // Scores outside [low, high] fall in the first or last bin.
+  static RankMetrics Histogram(const arma::rowvec& scores, const arma::rowvec& labels,
+                               double low, double high, size_t bins = 4096, size_t threads = 0);
+
+  // The bin of score among `bins` bins of `width` starting at low. Scores
+  // outside them, infinite ones included, fall in the first or last bin, and
+  // so does a NaN position (from an infinite low or width). The position is
+  // clamped in double because casting it to size_t out of range is undefined.
+  static size_t Bin(double score, double low, double width, size_t bins) {
+    double position = (score - low) / width;
+    if (!std::isfinite(position))
+      position = position > 0 ? bins - 1 : 0;
+    return (size_t)std::min(std::max(position, 0.0), (double)(bins - 1));
+  }
+
+  // From per-bin counts of positives and negatives, bins in ascending score
+  // order.
+  static RankMetrics FromHistogram(const uint64_t* positives, const uint64_t* negatives, size_t bins);
+
+  // Exact up to EXACT_LIMIT rows, otherwise a histogram over the score range.
+  static RankMetrics Compute(const arma::rowvec& scores, const arma::rowvec& labels);
+
+  static const size_t EXACT_LIMIT = 4000000;
+
+  std::string Report() const;
+};
+
+#endif // MLPACK_PROJECT_RANK_METRICS_H
@@ -0,0 +1,118 @@
+#include "ThresholdOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+double ratio(double numerator, double denominator) {
+  return denominator > 0 ? numerator / denominator : 0;
+}
+
+void writePoint(std::ostringstream& out, const char* title, ThresholdOptimizer::Point const& point,
+                ThresholdOptimizer::Values const& values) {
+  out << title << '\n'
+    << std::left << std::setprecision(4)
+    << std::setw(16) << "  threshold" << point.threshold << '\n'
+    << std::setw(16) << "  value" << point.Value(values) << '\n'
+    << std::setw(16) << "  approval rate" << point.ApprovalRate() << '\n'
+    << std::setw(16) << "  precision" << point.Precision() << '\n'
+    << std::setw(16) << "  recall" << point.Recall() << '\n'
+    << std::setw(16) << "  tp fp tn fn" << point.tp << ' ' << point.fp << ' ' << point.tn << ' ' << point.fn << '\n';
+}
+
+} // namespace
+
+double ThresholdOptimizer::Point::Precision() const {
+  // Rejecting nobody counts as perfectly precise, closing the curve.
+  return tp + fp > 0 ? tp / (tp + fp) : 1;
+}
+
+double ThresholdOptimizer::Point::Recall() const {
+  return ratio(tp, tp + fn);
+}
+
+double ThresholdOptimizer::Point::ApprovalRate() const {
+  return ratio(tn + fn, tp + fp + tn + fn);
+}
+
+double ThresholdOptimizer::Point::Value(Values const& values) const {
+  return tp * values.tp + fp * values.fp + tn * values.tn + fn * values.fn;
+}
+
+ThresholdOptimizer::ThresholdOptimizer(const arma::rowvec& scores, const arma::rowvec& labels) {
+  std::vector<std::pair<double, bool>> rows;
+  rows.reserve(scores.n_elem);
+  double positives = 0;
+  for (size_t i = 0; i < scores.n_elem; ++i) {
+    if (std::isnan(scores(i)))
+      continue;
+    rows.emplace_back(scores(i), labels(i) >= 0.5);
+    positives += rows.back().second;
+  }
+  std::sort(rows.begin(), rows.end(), std::greater<std::pair<double, bool>>());
+
+  Point point = {std::numeric_limits<double>::infinity(), 0, 0, rows.size() - positives, positives};
+  points.push_back(point);
+  for (size_t i = 0; i < rows.size();) {
+    point.threshold = rows[i].first;
+    for (; i < rows.size() && rows[i].first == point.threshold; ++i) {
+      if (rows[i].second) {
+        ++point.tp;
+        --point.fn;
+      } else {
+        ++point.fp;
+        --point.tn;
+      }
+    }
+    points.push_back(point);
+  }
+}
+
+ThresholdOptimizer::Point const& ThresholdOptimizer::BestValue(Values const& values) const {
+  size_t best = 0;
+  for (size_t i = 1; i < points.size(); ++i) {
+    if (points[i].Value(values) > points[best].Value(values))
+      best = i;
+  }
+  return points[best];
+}
+
+ThresholdOptimizer::Point const& ThresholdOptimizer::ForApprovalRate(double rate) const {
+  // Approval only falls as the threshold is lowered.
+  size_t chosen = 0;
+  for (size_t i = 1; i < points.size() && points[i].ApprovalRate() >= rate; ++i)
+    chosen = i;
+  return points[chosen];
+}
+
+std::string ThresholdOptimizer::Report(Values const& values, double approvalRate, size_t curvePoints) const {
+  std::ostringstream out;
+  out << "value per outcome: tp " << values.tp << ", fp " << values.fp
+    << ", tn " << values.tn << ", fn " << values.fn << '\n' << '\n';
+  writePoint(out, "best expected value", BestValue(values), values);
+  if (approvalRate >= 0) {
+    out << '\n';
+    std::ostringstream title;
+    title << "approval rate >= " << approvalRate;
+    writePoint(out, title.str().c_str(), ForApprovalRate(approvalRate), values);
+  }
+
+  out << '\n' << std::right
+    << std::setw(14) << "threshold" << std::setw(12) << "precision"
+    << std::setw(12) << "recall" << std::setw(12) << "approval" << '\n';
+  const size_t n = points.size();
+  const size_t shown = curvePoints == 0 ? n : std::min(curvePoints, n);
+  for (size_t k = 0; k < shown; ++k) {
+    const size_t i = shown == 1 ? 0 : k * (n - 1) / (shown - 1);
+    out << std::setprecision(6) << std::setw(14) << points[i].threshold
+      << std::setprecision(4) << std::setw(12) << points[i].Precision()
+      << std::setw(12) << points[i].Recall()
+      << std::setw(12) << points[i].ApprovalRate() << '\n';
+  }
+  return out.str();
+}
@@ -0,0 +1,63 @@
+#ifndef MLPACK_PROJECT_THRESHOLD_OPTIMIZER_H
+#define MLPACK_PROJECT_THRESHOLD_OPTIMIZER_H
+
+#include <string>
+#include <vector>
+#include <mlpack.hpp>
+
+// Chooses the score cutoff above which customers are treated as positive
+// (likely to default) and rejected.
+//
+// The scores are sorted once, descending. Lowering the cutoff past each
+// distinct score moves that score's rows to the positive side, so one pass
+// yields the confusion counts at every candidate cutoff. Any cutoff rule is
+// then a scan over those points: the best expected value under a matrix of
+// per-outcome values, or the cutoff that meets a target approval rate.
+class ThresholdOptimizer {
+public:
+  // Value of each outcome per customer. Positive means rejected; with the
+  // defaults, approving a good customer earns 1 and approving a defaulter
+  // loses 5.
+  struct Values {
+    double tp = 0;
+    double fp = 0;
+    double tn = 1;
+    double fn = -5;
+  };
+
+  // Confusion counts when rows with score >= threshold are positive.
+  struct Point {
+    double threshold;
+    double tp;
+    double fp;
+    double tn;
+    double fn;
+
+    double Precision() const;
+    double Recall() const;
+    double ApprovalRate() const;
+    double Value(Values const& values) const;
+  };
+
+  // Labels >= 0.5 are positive. NaN scores are skipped.
+  ThresholdOptimizer(const arma::rowvec& scores, const arma::rowvec& labels);
+
+  // The first point rejects nobody (threshold +inf); each following one
+  // lowers the threshold to the next distinct score.
+  std::vector<Point> const& Points() const { return points; }
+
+  Point const& BestValue(Values const& values) const;
+
+  // The lowest threshold that still approves at least the given fraction.
+  Point const& ForApprovalRate(double rate) const;
+
+  // The best cutoff, optionally the cutoff for a target approval rate (when
+  // approvalRate >= 0), and the precision-recall curve at up to curvePoints
+  // evenly spaced cutoffs (all of them when 0).
+  std::string Report(Values const& values, double approvalRate, size_t curvePoints) const;
+
+private:
+  std::vector<Point> points;
+};
+
+#endif // MLPACK_PROJECT_THRESHOLD_OPTIMIZER_H
@@ -0,0 +1,173 @@
+#include "Explainer.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include "../util/Json.h"
+#include "../util/Random.h"
+
+const size_t Explainer::MAX_PERMUTATIONS;
+
+Explainer::Explainer(LinearRegression const &lr,
+                     DecisionTree<> const &dt,
+                     FFNWeights const &nn,
+                     data::MinMaxScaler const &scalar,
+                     const arma::mat &background,
+                     uint64_t version)
+    : dims(background.n_rows), version(version),
+      treeShap(FlatTree::Build(dt, background.n_rows), background),
+      weights(nn), background(background) {
+  if (background.n_cols == 0)
+    throw std::runtime_error("Explanations need background data");
+  if (nn.w1.n_cols != dims)
+    throw std::runtime_error("Network does not match the background dimensionality");
+
+  const arma::vec &parameters = lr.Parameters();
+  const size_t first = lr.Intercept() ? 1 : 0;
+  if (parameters.n_elem != dims + first)
+    throw std::runtime_error("Linear model does not match the background dimensionality");
+  lrIntercept = lr.Intercept() ? parameters(0) : 0;
+  lrCoef.assign(parameters.begin() + first, parameters.end());
+
+  const arma::vec columnMean = arma::mean(background, 1);
+  mean.assign(columnMean.begin(), columnMean.end());
+
+  // data::MinMaxScaler maps x to (x - itemMin) * scale + scaleMin.
+  for (size_t i = 0; i < dims; ++i) {
+    scale.push_back(scalar.Scale()(i));
+    offset.push_back(scalar.ScaleMin() - scalar.ItemMin()(i) * scalar.Scale()(i));
+    fieldMin.push_back(scalar.ItemMin()(i));
+    fieldMax.push_back(scalar.ItemMax()(i));
+  }
+}
+
+void Explainer::ScoreLinear(const arma::mat &encoded, arma::rowvec &scores) const {
+  scores = arma::rowvec(lrCoef) * encoded + lrIntercept;
+}
+
+void Explainer::ScoreTree(const arma::mat &encoded, arma::rowvec &scores) const {
+  arma::Row<size_t> classes;
+  ClassifyTree(encoded, classes, scores);
+}
+
+void Explainer::ClassifyTree(const arma::mat &encoded, arma::Row<size_t> &classes, arma::rowvec &scores) const {
+  FlatTree const &tree = treeShap.Tree();
+  classes.set_size(encoded.n_cols);
+  scores.set_size(encoded.n_cols);
+  for (size_t c = 0; c < encoded.n_cols; ++c)
+    classes(c) = tree.Classify(encoded.colptr(c), 1, scores(c));
+}
+
+void Explainer::ScoreNetwork(const arma::mat &encoded, arma::rowvec &scores) const {
+  arma::mat scaled = encoded;
+  scaled.each_col() %= arma::vec(scale);
+  scaled.each_col() += arma::vec(offset);
+  weights.Forward(scaled, scores);
+}
+
+Explanation Explainer::Linear(const double *encoded) const {
+  Explanation explanation;
+  explanation.base = lrIntercept;
+  explanation.value = lrIntercept;
+  explanation.contributions.resize(dims);
+  for (size_t i = 0; i < dims; ++i) {
+    explanation.base += lrCoef[i] * mean[i];
+    explanation.value += lrCoef[i] * encoded[i];
+    explanation.contributions[i] = lrCoef[i] * (encoded[i] - mean[i]);
+  }
+  return explanation;
+}
+
+Explanation Explainer::Tree(const double *encoded) const {
+  Explanation explanation;
+  explanation.base = treeShap.ExpectedValue();
+  explanation.contributions.resize(dims);
+  explanation.value = treeShap.Explain(encoded, explanation.contributions.data());
+  return explanation;
+}
+
+Explanation Explainer::Network(const double *encoded, size_t permutations, uint64_t seed) const {
+  const size_t pairs = std::max<size_t>(1, (std::min(permutations, MAX_PERMUTATIONS) + 1) / 2);
+  const size_t steps = dims + 1;
+
+  // Column block p * steps starts at a background row and ends at the
+  // customer, with one more field switched in each column.
+  std::vector<size_t> order(2 * pairs * dims);
+  arma::mat walks(dims, 2 * pairs * steps);
+  std::vector<double> target(dims);
+  for (size_t i = 0; i < dims; ++i)
+    target[i] = scale[i] * encoded[i] + offset[i];
+
+  for (size_t pair = 0; pair < pairs; ++pair) {
+    uint64_t state = mix(seed ^ mix(pair + 1));
+    const double *row = background.colptr(state % background.n_cols);
+
+    size_t *forward = &order[2 * pair * dims];
+    size_t *reverse = forward + dims;
+    std::iota(forward, forward + dims, 0);
+    for (size_t i = dims; i > 1; --i) {
+      state = mix(state + 0x9e3779b97f4a7c15ULL);
+      std::swap(forward[i - 1], forward[state % i]);
+    }
+    std::reverse_copy(forward, forward + dims, reverse);
+
+    for (size_t walk = 2 * pair; walk < 2 * pair + 2; ++walk) {
+      double *column = walks.colptr(walk * steps);
+      for (size_t i = 0; i < dims; ++i)
+        column[i] = scale[i] * row[i] + offset[i];
+      for (size_t j = 0; j < dims; ++j) {
+        std::copy(column, column + dims, column + dims);
+        column += dims;
+        column[order[walk * dims + j]] = target[order[walk * dims + j]];
+      }
+    }
+  }
+
+  arma::rowvec predictions;
+  weights.Forward(walks, predictions);
+
+  Explanation explanation;
+  explanation.base = 0;
+  explanation.contributions.assign(dims, 0);
+  const size_t walkCount = 2 * pairs;
+  for (size_t walk = 0; walk < walkCount; ++walk) {
+    const double *output = predictions.memptr() + walk * steps;
+    explanation.base += output[0];
+    for (size_t j = 0; j < dims; ++j)
+      explanation.contributions[order[walk * dims + j]] += output[j + 1] - output[j];
+  }
+  explanation.base /= walkCount;
+  for (double &contribution : explanation.contributions)
+    contribution /= walkCount;
+  explanation.value = predictions(steps - 1);
+  return explanation;
+}
+
+void Explainer::AppendJson(std::string &out,
+                           Explanation const &explanation,
+                           std::vector<std::string> const &fieldNames,
+                           size_t top) {
+  std::vector<size_t> fields(explanation.contributions.size());
+  std::iota(fields.begin(), fields.end(), 0);
+  std::stable_sort(fields.begin(), fields.end(), [&](size_t a, size_t b) {
+    return explanation.contributions[a] > explanation.contributions[b];
+  });
+  if (top > 0 && top < fields.size())
+    fields.resize(top);
+
+  out += "{\"value\":";
+  appendNumber(out, explanation.value);
+  out += ",\"base\":";
+  appendNumber(out, explanation.base);
+  out += ",\"contributions\":[";
+  for (size_t k = 0; k < fields.size(); ++k) {
+    if (k > 0)
+      out += ',';
+    out += "{\"field\":\"";
+    out += fieldNames[fields[k]];
+    out += "\",\"contribution\":";
+    appendNumber(out, explanation.contributions[fields[k]]);
+    out += '}';
+  }
+  out += "]}";
+}
@@ -0,0 +1,95 @@
+#ifndef MLPACK_PROJECT_EXPLAINER_H
+#define MLPACK_PROJECT_EXPLAINER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mlpack.hpp>
+#include "TreeShap.h"
+#include "../scoring/FFNWeights.h"
+
+using namespace mlpack;
+
+// Contributions of every field to one customer's score.
+struct Explanation {
+  double base;    // Expected score over the background data
+  double value;   // Score of the customer
+  std::vector<double> contributions;  // One per field; they sum to value - base
+};
+
+// SHAP explanations of the three models against a background data set,
+// normally the training data:
+//
+//   - linear regression: exactly w_i (x_i - mean_i), one multiply per field;
+//   - decision tree: exact TreeSHAP of the leaf probability of class 1;
+//   - network: permutation sampling SHAP. For every sampled permutation and
+//     background row, the fields are switched from the background row to the
+//     customer one at a time, and each step's change in the output is
+//     credited to the field switched. All of those rows go through one
+//     batched forward pass. Every permutation is paired with its reverse,
+//     which lowers the variance.
+//
+// The explainer keeps its own copies of the models, so it also scores the
+// what-if and stats routes' batches for the model version it was built from,
+// without touching the mlpack models /load overwrites.
+//
+// Everything is read-only after construction, so a built Explainer can serve
+// several threads.
+class Explainer {
+public:
+  // background holds encoded rows, one per column.
+  Explainer(LinearRegression const &lr,
+            DecisionTree<> const &dt,
+            FFNWeights const &nn,
+            data::MinMaxScaler const &scalar,
+            const arma::mat &background,
+            uint64_t version = 0);
+
+  Explanation Linear(const double *encoded) const;
+  Explanation Tree(const double *encoded) const;
+  // permutations is rounded up to an even number.
+  Explanation Network(const double *encoded, size_t permutations, uint64_t seed) const;
+
+  // The model version the explainer was built from.
+  uint64_t Version() const { return version; }
+
+  // Score every column of encoded: the linear model, the tree's probability
+  // of class 1 and the network.
+  void ScoreLinear(const arma::mat &encoded, arma::rowvec &scores) const;
+  void ScoreTree(const arma::mat &encoded, arma::rowvec &scores) const;
+  void ClassifyTree(const arma::mat &encoded, arma::Row<size_t> &classes, arma::rowvec &scores) const;
+  void ScoreNetwork(const arma::mat &encoded, arma::rowvec &scores) const;
+
+  // The range of each field the scaler was fitted on.
+  double FieldMin(size_t field) const { return fieldMin[field]; }
+  double FieldMax(size_t field) const { return fieldMax[field]; }
+
+  // {"value":...,"base":...,"contributions":[{"field":...,"contribution":...},...]}
+  // with the contributions sorted from the one raising the score most, and
+  // at most `top` of them (0 for all).
+  static void AppendJson(std::string &out,
+                         Explanation const &explanation,
+                         std::vector<std::string> const &fieldNames,
+                         size_t top = 0);
+
+  static const size_t MAX_PERMUTATIONS = 1024;
+
+private:
+  size_t dims;
+  uint64_t version;
+
+  double lrIntercept;
+  std::vector<double> lrCoef;
+  std::vector<double> mean;
+
+  TreeShap treeShap;
+
+  FFNWeights weights;
+  std::vector<double> scale;    // Scaled x = scale * x + offset, per field
+  std::vector<double> offset;
+  std::vector<double> fieldMin;
+  std::vector<double> fieldMax;
+  arma::mat background;
+};
+
+#endif // MLPACK_PROJECT_EXPLAINER_H
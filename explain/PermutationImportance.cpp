@@ -0,0 +1,125 @@
+#include "PermutationImportance.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include "../eval/RankMetrics.h"
+#include "../util/Parallel.h"
+#include "../util/Random.h"
+
+namespace {
+
+struct Drop {
+  double auc;
+  double accuracy;
+};
+
+} // namespace
+
+PermutationImportance::PermutationImportance(Scorer scorer,
+                                             const arma::mat &data,
+                                             const arma::rowvec &labels,
+                                             size_t threads)
+    : scorer(scorer), data(data), labels(labels),
+      threads(threads == 0 ? defaultThreadCount() : threads) {
+  arma::rowvec scores(data.n_cols);
+  std::vector<size_t> correct(this->threads, 0);
+  parallelFor(data.n_cols, 1024, [&](size_t worker, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      scores(i) = this->scorer(data.colptr(i));
+      correct[worker] += (scores(i) >= 0.5) == (this->labels(i) >= 0.5);
+    }
+  }, this->threads);
+
+  size_t total = 0;
+  for (size_t count : correct)
+    total += count;
+  baselineAccuracy = data.n_cols ? (double)total / data.n_cols : 0;
+  baselineAuc = RankMetrics::Exact(scores, this->labels, this->threads).auc;
+}
+
+std::vector<PermutationImportance::Importance> PermutationImportance::Run(size_t repeats, uint64_t seed) const {
+  const size_t rows = data.n_cols;
+  const size_t dims = data.n_rows;
+  repeats = std::max<size_t>(1, repeats);
+
+  // Per-thread scratch: the shuffled column, one row, and the scores.
+  std::vector<std::vector<double>> column(threads, std::vector<double>(rows));
+  std::vector<std::vector<double>> row(threads, std::vector<double>(dims));
+  std::vector<arma::rowvec> scores(threads, arma::rowvec(rows));
+  std::vector<Drop> drops(dims * repeats);
+
+  parallelFor(dims * repeats, 1, [&](size_t worker, size_t begin, size_t end) {
+    for (size_t task = begin; task < end; ++task) {
+      const size_t field = task / repeats;
+      double *shuffled = column[worker].data();
+      for (size_t i = 0; i < rows; ++i)
+        shuffled[i] = data(field, i);
+      uint64_t state = mix(seed ^ mix(task + 1));
+      for (size_t i = rows; i > 1; --i) {
+        state = mix(state + 0x9e3779b97f4a7c15ULL);
+        std::swap(shuffled[i - 1], shuffled[state % i]);
+      }
+
+      double *x = row[worker].data();
+      arma::rowvec &s = scores[worker];
+      size_t correct = 0;
+      for (size_t i = 0; i < rows; ++i) {
+        const double *original = data.colptr(i);
+        std::copy(original, original + dims, x);
+        x[field] = shuffled[i];
+        s(i) = scorer(x);
+        correct += (s(i) >= 0.5) == (labels(i) >= 0.5);
+      }
+
+      drops[task].auc = baselineAuc - RankMetrics::Exact(s, labels, 1).auc;
+      drops[task].accuracy = baselineAccuracy - (rows ? (double)correct / rows : 0);
+    }
+  }, threads);
+
+  std::vector<Importance> importances;
+  for (size_t field = 0; field < dims; ++field) {
+    Importance importance = {field, 0, 0, 0, 0};
+    for (size_t r = 0; r < repeats; ++r) {
+      importance.aucDrop += drops[field * repeats + r].auc;
+      importance.accuracyDrop += drops[field * repeats + r].accuracy;
+    }
+    importance.aucDrop /= repeats;
+    importance.accuracyDrop /= repeats;
+    for (size_t r = 0; r < repeats && repeats > 1; ++r) {
+      const Drop &drop = drops[field * repeats + r];
+      importance.aucStd += (drop.auc - importance.aucDrop) * (drop.auc - importance.aucDrop);
+      importance.accuracyStd +=
+        (drop.accuracy - importance.accuracyDrop) * (drop.accuracy - importance.accuracyDrop);
+    }
+    if (repeats > 1) {
+      importance.aucStd = std::sqrt(importance.aucStd / (repeats - 1));
+      importance.accuracyStd = std::sqrt(importance.accuracyStd / (repeats - 1));
+    }
+    importances.push_back(importance);
+  }
+
+  std::stable_sort(importances.begin(), importances.end(), [](Importance const &a, Importance const &b) {
+    return a.aucDrop > b.aucDrop;
+  });
+  return importances;
+}
+
+std::string PermutationImportance::Report(std::vector<Importance> const &importances,
+                                          std::vector<std::string> const &fieldNames,
+                                          size_t repeats) const {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(4)
+    << "baseline AUC: " << baselineAuc << ", accuracy: " << baselineAccuracy
+    << ", repeats: " << repeats << '\n' << '\n'
+    << std::left << std::setw(18) << "field" << std::right
+    << std::setw(12) << "AUC drop" << std::setw(10) << "std"
+    << std::setw(12) << "acc drop" << std::setw(10) << "std" << '\n';
+  for (Importance const &importance : importances) {
+    out << std::left << std::setw(18) << fieldNames[importance.field] << std::right
+      << std::setw(12) << importance.aucDrop << std::setw(10) << importance.aucStd
+      << std::setw(12) << importance.accuracyDrop << std::setw(10) << importance.accuracyStd << '\n';
+  }
+  return out.str();
+}
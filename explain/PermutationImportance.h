@@ -0,0 +1,57 @@
+#ifndef MLPACK_PROJECT_PERMUTATION_IMPORTANCE_H
+#define MLPACK_PROJECT_PERMUTATION_IMPORTANCE_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <mlpack.hpp>
+
+// Permutation feature importance: how much a model's ROC-AUC and accuracy
+// drop when one field's values are shuffled across the rows, which breaks
+// the field's link to the label while keeping its distribution.
+//
+// Each (field, repeat) pair is one task, and tasks are handed to threads from
+// a shared counter. A task shuffles only that field's values into a
+// per-thread scratch column, then scores each row from a copy of the row
+// with the shuffled value swapped in, so the data set itself is never
+// copied. Shuffles come from a generator keyed by the seed and the task (see
+// util/Random.h).
+class PermutationImportance {
+public:
+  // Scores one encoded row. Called from several threads at once.
+  typedef std::function<double(const double *)> Scorer;
+
+  struct Importance {
+    size_t field;
+    double aucDrop;       // Mean over repeats
+    double aucStd;
+    double accuracyDrop;
+    double accuracyStd;
+  };
+
+  // data holds encoded rows, one per column, and must outlive the object. A
+  // row is predicted positive when its score is at least 0.5; labels >= 0.5
+  // are positive.
+  PermutationImportance(Scorer scorer, const arma::mat &data, const arma::rowvec &labels, size_t threads = 0);
+
+  double BaselineAuc() const { return baselineAuc; }
+  double BaselineAccuracy() const { return baselineAccuracy; }
+
+  // Importances of every field, largest AUC drop first.
+  std::vector<Importance> Run(size_t repeats, uint64_t seed = 42) const;
+
+  std::string Report(std::vector<Importance> const &importances,
+                     std::vector<std::string> const &fieldNames,
+                     size_t repeats) const;
+
+private:
+  Scorer scorer;
+  const arma::mat &data;
+  arma::rowvec labels;
+  size_t threads;
+  double baselineAuc;
+  double baselineAccuracy;
+};
+
+#endif // MLPACK_PROJECT_PERMUTATION_IMPORTANCE_H
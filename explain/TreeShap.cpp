@@ -0,0 +1,148 @@
+#include "TreeShap.h"
+
+#include <algorithm>
+
+namespace {
+
+// Adds a feature to the path with the given pass fractions.
+template<typename Element>
+void extend(Element *path, size_t depth, double zero, double one, long feature) {
+  path[depth].feature = feature;
+  path[depth].zero = zero;
+  path[depth].one = one;
+  path[depth].weight = depth == 0 ? 1.0 : 0.0;
+  for (size_t i = depth; i-- > 0;) {
+    path[i + 1].weight += one * path[i].weight * (i + 1) / (double)(depth + 1);
+    path[i].weight = zero * path[i].weight * (depth - i) / (double)(depth + 1);
+  }
+}
+
+// Removes the element at index from the path, undoing extend().
+template<typename Element>
+void unwind(Element *path, size_t depth, size_t index) {
+  const double one = path[index].one;
+  const double zero = path[index].zero;
+  double next = path[depth].weight;
+  for (size_t i = depth; i-- > 0;) {
+    if (one != 0) {
+      const double weight = path[i].weight;
+      path[i].weight = next * (depth + 1) / ((i + 1) * one);
+      next = weight - path[i].weight * zero * (depth - i) / (double)(depth + 1);
+    } else {
+      path[i].weight = path[i].weight * (depth + 1) / (zero * (depth - i));
+    }
+  }
+  for (size_t i = index; i < depth; ++i) {
+    path[i].feature = path[i + 1].feature;
+    path[i].zero = path[i + 1].zero;
+    path[i].one = path[i + 1].one;
+  }
+}
+
+// Total weight of the path as if the element at index had been unwound.
+template<typename Element>
+double unwoundSum(const Element *path, size_t depth, size_t index) {
+  const double one = path[index].one;
+  const double zero = path[index].zero;
+  double next = path[depth].weight;
+  double total = 0;
+  for (size_t i = depth; i-- > 0;) {
+    if (one != 0) {
+      const double weight = next * (depth + 1) / ((i + 1) * one);
+      total += weight;
+      next = path[i].weight - weight * zero * (depth - i) / (double)(depth + 1);
+    } else {
+      total += path[i].weight / zero * (depth + 1) / (double)(depth - i);
+    }
+  }
+  return total;
+}
+
+} // namespace
+
+TreeShap::TreeShap(FlatTree const &tree, const arma::mat &background, size_t outputClass)
+    : tree(tree), outputClass(std::min(outputClass, tree.NumClasses() - 1)),
+      cover(tree.Nodes().size(), 0) {
+  std::vector<FlatTree::Node> const &nodes = tree.Nodes();
+  for (size_t c = 0; c < background.n_cols; ++c) {
+    const double *x = background.colptr(c);
+    size_t i = 0;
+    ++cover[0];
+    while (nodes[i].right != 0) {
+      i = x[nodes[i].dimension] <= nodes[i].threshold ? i + 1 : nodes[i].right;
+      ++cover[i];
+    }
+  }
+  expected = expectation(0);
+}
+
+// Share of the parent's background rows that go to child. Nodes no
+// background row reaches split evenly.
+double TreeShap::fraction(size_t child, size_t parent) const {
+  return cover[parent] > 0 ? cover[child] / cover[parent] : 0.5;
+}
+
+double TreeShap::value(size_t node) const {
+  return tree.LeafProbabilities(tree.Nodes()[node].dimension)[outputClass];
+}
+
+double TreeShap::expectation(size_t node) const {
+  FlatTree::Node const &n = tree.Nodes()[node];
+  if (n.right == 0)
+    return value(node);
+  return fraction(node + 1, node) * expectation(node + 1) +
+         fraction(n.right, node) * expectation(n.right);
+}
+
+double TreeShap::Explain(const double *x, double *phi) const {
+  std::fill(phi, phi + tree.Dimensionality(), 0.0);
+  // Every level of the recursion gets its own copy of the path.
+  const size_t levels = tree.Depth() + 2;
+  std::vector<PathElement> paths(levels * (levels + 1));
+  recurse(x, phi, 0, paths.data(), 0, 1, 1, -1);
+
+  std::vector<double> probabilities(tree.NumClasses());
+  tree.Classify(x, probabilities.data());
+  return probabilities[outputClass];
+}
+
+void TreeShap::recurse(const double *x, double *phi, size_t node, PathElement *parentPath, size_t depth,
+                       double zero, double one, long feature) const {
+  PathElement *path = parentPath + depth + 1;
+  std::copy(parentPath, parentPath + depth + 1, path);
+  extend(path, depth, zero, one, feature);
+
+  FlatTree::Node const &n = tree.Nodes()[node];
+  if (n.right == 0) {
+    const double leaf = value(node);
+    for (size_t i = 1; i <= depth; ++i) {
+      const double weight = unwoundSum(path, depth, i);
+      phi[path[i].feature] += weight * (path[i].one - path[i].zero) * leaf;
+    }
+    return;
+  }
+
+  const size_t hot = x[n.dimension] <= n.threshold ? node + 1 : n.right;
+  const size_t cold = hot == n.right ? node + 1 : n.right;
+
+  // A feature split on again higher up the path is replaced, so it counts once.
+  double incomingZero = 1, incomingOne = 1;
+  size_t k = 1;
+  while (k <= depth && path[k].feature != (long)n.dimension)
+    ++k;
+  if (k <= depth) {
+    incomingZero = path[k].zero;
+    incomingOne = path[k].one;
+    unwind(path, depth, k);
+    --depth;
+  }
+
+  // A branch no coalition reaches contributes nothing, and its all-zero path
+  // element could not be unwound.
+  const double hotZero = incomingZero * fraction(hot, node);
+  const double coldZero = incomingZero * fraction(cold, node);
+  if (hotZero != 0 || incomingOne != 0)
+    recurse(x, phi, hot, path, depth + 1, hotZero, incomingOne, n.dimension);
+  if (coldZero != 0)
+    recurse(x, phi, cold, path, depth + 1, coldZero, 0, n.dimension);
+}
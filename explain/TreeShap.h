@@ -0,0 +1,53 @@
+#ifndef MLPACK_PROJECT_TREE_SHAP_H
+#define MLPACK_PROJECT_TREE_SHAP_H
+
+#include <vector>
+#include <mlpack.hpp>
+#include "../scoring/FlatTree.h"
+
+// Exact SHAP values of a decision tree's probability of one class, computed
+// by path-dependent TreeSHAP (Lundberg et al., "Consistent Individualized
+// Feature Attribution for Tree Ensembles").
+//
+// A feature missing from a coalition follows both branches of its splits,
+// weighted by how many background rows reached each child (the node
+// covers). One pass down the tree keeps, per root-to-leaf path, the
+// proportion of coalitions of every size that reach the leaf. The cost is
+// O(leaves x depth^2) per explanation instead of exponential in the number
+// of features.
+class TreeShap {
+public:
+  // Counts how many columns of background reach every node.
+  TreeShap(FlatTree const &tree, const arma::mat &background, size_t outputClass = 1);
+
+  // Expected probability over the background rows.
+  double ExpectedValue() const { return expected; }
+
+  // Writes one value per feature into phi; they sum to the probability of x
+  // minus ExpectedValue(). Returns the probability of x.
+  double Explain(const double *x, double *phi) const;
+
+  size_t Dimensionality() const { return tree.Dimensionality(); }
+  FlatTree const &Tree() const { return tree; }
+
+private:
+  struct PathElement {
+    long feature;
+    double zero;    // Fraction of coalitions without the feature that pass
+    double one;     // 1 if x passes, for coalitions with the feature
+    double weight;
+  };
+
+  FlatTree tree;
+  size_t outputClass;
+  std::vector<double> cover;
+  double expected;
+
+  double fraction(size_t child, size_t parent) const;
+  double value(size_t node) const;
+  double expectation(size_t node) const;
+  void recurse(const double *x, double *phi, size_t node, PathElement *path, size_t depth,
+               double zero, double one, long feature) const;
+};
+
+#endif // MLPACK_PROJECT_TREE_SHAP_H
@@ -0,0 +1,148 @@
+#include "WhatIf.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "../util/Json.h"
+
+namespace {
+
+void appendArray(std::string &out, std::vector<double> const &values) {
+  out += '[';
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (i > 0)
+      out += ',';
+    appendNumber(out, values[i]);
+  }
+  out += ']';
+}
+
+} // namespace
+
+const size_t WhatIf::MAX_POINTS;
+const size_t WhatIf::MAX_ROWS;
+const size_t WhatIf::MAX_CUSTOMERS;
+const size_t WhatIf::BLOCK_ROWS;
+
+WhatIf::WhatIf(CategoricalEncoder const &encoder,
+               std::vector<std::string> const &fieldNames,
+               std::shared_ptr<const Explainer> models)
+    : encoder(encoder), fieldNames(fieldNames), models(std::move(models)) {}
+
+WhatIf::Grid WhatIf::MakeGrid(std::string const &field, double from, double to, size_t points) const {
+  auto it = std::find(fieldNames.begin(), fieldNames.end(), field);
+  if (it == fieldNames.end())
+    throw std::invalid_argument("Unknown field: " + field);
+
+  Grid grid;
+  grid.field = it - fieldNames.begin();
+  if (encoder.IsCategorical(grid.field)) {
+    for (size_t code = 0; code < encoder.NumCategories(grid.field); ++code) {
+      grid.values.push_back((double)code);
+      grid.labels.push_back(encoder.CategoryName(grid.field, code));
+    }
+    return grid;
+  }
+
+  if (std::isnan(from))
+    from = models->FieldMin(grid.field);
+  if (std::isnan(to))
+    to = models->FieldMax(grid.field);
+  if (!(from <= to) || points == 0 || points > MAX_POINTS)
+    throw std::invalid_argument("Invalid grid for " + field);
+  if (points == 1 || from == to) {
+    grid.values.push_back(from);
+    return grid;
+  }
+  for (size_t k = 0; k < points; ++k)
+    grid.values.push_back(from + (to - from) * k / (points - 1));
+  return grid;
+}
+
+arma::mat WhatIf::Expand(const arma::mat &customers, Grid const &grid) {
+  const size_t points = grid.values.size();
+  arma::mat expanded(customers.n_rows, customers.n_cols * points);
+  for (size_t c = 0; c < customers.n_cols; ++c) {
+    for (size_t k = 0; k < points; ++k) {
+      double *column = expanded.colptr(c * points + k);
+      std::copy(customers.colptr(c), customers.colptr(c) + customers.n_rows, column);
+      column[grid.field] = grid.values[k];
+    }
+  }
+  return expanded;
+}
+
+void WhatIf::Score(PortfolioReader::PdModel model, const arma::mat &data, arma::rowvec &scores) const {
+  if (model == PortfolioReader::PdModel::LR)
+    models->ScoreLinear(data, scores);
+  else if (model == PortfolioReader::PdModel::DT)
+    models->ScoreTree(data, scores);
+  else
+    models->ScoreNetwork(data, scores);
+}
+
+WhatIf::Curve WhatIf::Run(PortfolioReader::PdModel model, const arma::mat &customers, Grid const &grid) const {
+  const size_t points = grid.values.size();
+  if (customers.n_cols == 0 || customers.n_cols > MAX_CUSTOMERS)
+    throw std::invalid_argument("Between 1 and " + std::to_string(MAX_CUSTOMERS) + " customers are allowed");
+  if (customers.n_cols * points > MAX_ROWS)
+    throw std::invalid_argument("At most " + std::to_string(MAX_ROWS) + " customers x grid points are allowed");
+
+  // Whole customers per block, so each block's scores land contiguously.
+  const size_t step = std::max<size_t>(1, BLOCK_ROWS / points);
+  arma::rowvec scores(customers.n_cols * points);
+  arma::rowvec block;
+  for (size_t first = 0; first < customers.n_cols; first += step) {
+    const size_t last = std::min(first + step, (size_t)customers.n_cols) - 1;
+    Score(model, Expand(customers.cols(first, last), grid), block);
+    scores.subvec(first * points, (last + 1) * points - 1) = block;
+  }
+
+  Curve curve;
+  curve.customers = customers.n_cols;
+  std::vector<double> column(customers.n_cols);
+  for (size_t k = 0; k < points; ++k) {
+    double sum = 0;
+    for (size_t c = 0; c < customers.n_cols; ++c) {
+      column[c] = scores(c * points + k);
+      sum += column[c];
+    }
+    curve.mean.push_back(sum / customers.n_cols);
+
+    const size_t low = (size_t)(0.1 * (customers.n_cols - 1));
+    const size_t high = (size_t)std::ceil(0.9 * (customers.n_cols - 1));
+    std::nth_element(column.begin(), column.begin() + low, column.end());
+    curve.p10.push_back(column[low]);
+    std::nth_element(column.begin(), column.begin() + high, column.end());
+    curve.p90.push_back(column[high]);
+  }
+  return curve;
+}
+
+void WhatIf::AppendJson(std::string &out, Grid const &grid, Curve const &curve) const {
+  out += "{\"field\":\"";
+  out += fieldNames[grid.field];
+  out += "\",\"customers\":";
+  out += std::to_string(curve.customers);
+  out += ",\"grid\":";
+  if (grid.labels.empty()) {
+    appendArray(out, grid.values);
+  } else {
+    out += '[';
+    for (size_t k = 0; k < grid.labels.size(); ++k) {
+      if (k > 0)
+        out += ',';
+      out += '"';
+      out += grid.labels[k];
+      out += '"';
+    }
+    out += ']';
+  }
+  out += ",\"mean\":";
+  appendArray(out, curve.mean);
+  out += ",\"p10\":";
+  appendArray(out, curve.p10);
+  out += ",\"p90\":";
+  appendArray(out, curve.p90);
+  out += '}';
+}
@@ -0,0 +1,80 @@
+#ifndef MLPACK_PROJECT_WHAT_IF_H
+#define MLPACK_PROJECT_WHAT_IF_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <mlpack.hpp>
+#include "Explainer.h"
+#include "../encoder/CategoricalEncoder.h"
+#include "../portfolio/PortfolioReader.h"
+
+using namespace mlpack;
+
+// What-if and partial dependence curves: how a model's score moves as one
+// field sweeps a grid of values, for one customer or averaged over many.
+//
+// Every customer is copied once per grid value with the field replaced, and
+// the rows are scored in batched calls: a matrix product for the linear
+// model, the flattened tree over every column, and a forward pass of the
+// network. Customers are expanded BLOCK_ROWS rows at a time, so a 100-point
+// curve over 1000 customers is 25 predicts of 4000 columns and memory stays
+// bounded whatever the request size.
+//
+// The models are the copies held by an Explainer, normally the one published
+// for the current model version, which the WhatIf keeps alive.
+class WhatIf {
+public:
+  // The values a field takes along the curve.
+  struct Grid {
+    size_t field;
+    std::vector<double> values;       // Encoded
+    std::vector<std::string> labels;  // Category names, for categorical fields
+  };
+
+  // Per grid value, the mean score over the customers and the 10th and 90th
+  // percentiles.
+  struct Curve {
+    size_t customers;
+    std::vector<double> mean;
+    std::vector<double> p10;
+    std::vector<double> p90;
+  };
+
+  WhatIf(CategoricalEncoder const &encoder,
+         std::vector<std::string> const &fieldNames,
+         std::shared_ptr<const Explainer> models);
+
+  // A categorical field sweeps all its categories. A numeric one sweeps
+  // `points` evenly spaced values from `from` to `to`, which default (NaN) to
+  // the range the scaler was fitted on.
+  // Throws std::invalid_argument for an unknown field or an empty range.
+  Grid MakeGrid(std::string const &field, double from, double to, size_t points) const;
+
+  // customers holds encoded rows, one per column. Column c * points + k of the
+  // result is customer c with the field set to grid value k.
+  static arma::mat Expand(const arma::mat &customers, Grid const &grid);
+
+  // Scores every column of data with one batched call of the model. The tree
+  // gives its leaf probability of class 1.
+  void Score(PortfolioReader::PdModel model, const arma::mat &data, arma::rowvec &scores) const;
+
+  // Throws std::invalid_argument for more than MAX_CUSTOMERS customers or
+  // MAX_ROWS customers x grid points.
+  Curve Run(PortfolioReader::PdModel model, const arma::mat &customers, Grid const &grid) const;
+
+  // {"field":...,"customers":...,"grid":[...],"mean":[...],"p10":[...],"p90":[...]}
+  void AppendJson(std::string &out, Grid const &grid, Curve const &curve) const;
+
+  static const size_t MAX_POINTS = 1000;
+  static const size_t MAX_ROWS = 250000;
+  static const size_t MAX_CUSTOMERS = 10000;
+  static const size_t BLOCK_ROWS = 4096;
+
+private:
+  CategoricalEncoder const &encoder;
+  std::vector<std::string> fieldNames;
+  std::shared_ptr<const Explainer> models;
+};
+
+#endif // MLPACK_PROJECT_WHAT_IF_H
@@ -41,29 +41,27 @@ void ModelGenerator::generateBaseDT() {
   std::cout << "Decision Tree Model generated!" << '\n';
 }
 
-void ModelGenerator::generateBaseFNN(
-    FFN<MeanSquaredError, RandomInitialization> &model) {
+namespace {
 
-  // Scale all data into the range (0, 1) for increased numerical stability.
-  data::MinMaxScaler scaleX;
-  arma::mat scTrainX;
-  scaleX.Fit(trainX);
-  scaleX.Transform(trainX, scTrainX);
-
-  // Save Scalar to reuse when transforming input
-  data::Save("data/scalar.bin", "scalar", scaleX, true);
+// Builds and trains the network. Shared by the double and float models, which
+// differ only in the matrix type of their layers.
+template<typename NetworkType, typename MatType>
+void trainFNN(NetworkType &model, const MatType &scTrainX, const MatType &trainY) {
 
   const int EPOCHS = 1000;
   constexpr double STEP_SIZE = 5e-2;
   constexpr int BATCH_SIZE = 32;
   constexpr double STOP_TOLERANCE = 1e-8;
 
+  // Start from an empty network so calling this again does not stack layers.
+  model = NetworkType();
+
   // ========== Feed Forward Neural Network ========== /
-  model.Add<Linear>(32);
-  model.Add<FlexibleReLU>();
-  model.Add<Linear>(16);
-  model.Add<Sigmoid>();
-  model.Add<Linear>(1);
+  model.template Add<LinearType<MatType>>(32);
+  model.template Add<FlexibleReLUType<MatType>>();
+  model.template Add<LinearType<MatType>>(16);
+  model.template Add<SigmoidType<MatType>>();
+  model.template Add<LinearType<MatType>>(1);
 
   // Optimizer
   ens::Adam optimizer(
@@ -86,6 +84,40 @@ void ModelGenerator::generateBaseFNN(
                             // or no improvement has been made. This will terminate the
                             // optimization once we obtain a minima on training set.
       ens::EarlyStopAtMinLoss(20)); 
+}
 
+} // namespace
+
+void ModelGenerator::generateBaseFNN(
+    FFN<MeanSquaredError, RandomInitialization> &model) {
+
+  // Scale all data into the range (0, 1) for increased numerical stability.
+  data::MinMaxScaler scaleX;
+  arma::mat scTrainX;
+  scaleX.Fit(trainX);
+  scaleX.Transform(trainX, scTrainX);
+
+  // Save Scalar to reuse when transforming input
+  data::Save("data/scalar.bin", "scalar", scaleX, true);
+
+  trainFNN(model, scTrainX, trainY);
+
+  data::Save("models/nn.bin", "nn", model, true);
   std::cout << "FNN generated!" <<'\n';
 }
+
+void ModelGenerator::generateBaseFNN32(FloatFFN &model) {
+
+  // Same scaling as the double model, so both share data/scalar.bin.
+  data::MinMaxScaler scaleX;
+  arma::mat scTrainX;
+  scaleX.Fit(trainX);
+  scaleX.Transform(trainX, scTrainX);
+
+  trainFNN(model,
+      arma::conv_to<arma::fmat>::from(scTrainX),
+      arma::conv_to<arma::fmat>::from(trainY));
+
+  data::Save("models/nn_f32.bin", "nn", model, true);
+  std::cout << "Float FNN generated!" <<'\n';
+}
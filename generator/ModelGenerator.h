@@ -7,6 +7,9 @@
 
 using namespace mlpack;
 
+// Single-precision variant of the neural network.
+typedef FFN<MeanSquaredErrorType<arma::fmat>, RandomInitialization, arma::fmat> FloatFFN;
+
 class ModelGenerator {
 private:
   arma::mat trainX;
@@ -17,6 +20,7 @@ public:
 
   void generateBaseLinReg();
   void generateBaseFNN(FFN<MeanSquaredError, RandomInitialization> &model);
+  void generateBaseFNN32(FloatFFN &model);
   void generateBaseDT();
   void runTunedLinReg();
 };
@@ -3,11 +3,332 @@
 #include <iostream>
 #include "generator/ModelGenerator.h"
 #include "eval/ModelEvaluator.h"
+#include "eval/RankMetrics.h"
+#include "eval/GroupedEvaluator.h"
+#include "eval/Bootstrap.h"
+#include "eval/ThresholdOptimizer.h"
 #include "deserializer/PredictRequestDeserializer.h"
+#include "dataset/TrainingData.h"
+#include "server/ConcurrencyLimiter.h"
+#include "server/ServerOptions.h"
+#include "server/Compression.h"
+#include "cache/PredictionCache.h"
+#include "batch/BatchScorer.h"
+#include "scoring/Float32Models.h"
+#include "scoring/QuantizedFFN.h"
+#include "scoring/ContributionTables.h"
+#include "scoring/FlatTree.h"
+#include "scoring/GeneratedTree.h"
+#include "scoring/ModelSet.h"
+#include "scoring/Cascade.h"
+#include "portfolio/PortfolioReader.h"
+#include "portfolio/ExpectedLoss.h"
+#include "portfolio/MonteCarlo.h"
+#include "stress/StressEngine.h"
+#include "explain/Explainer.h"
+#include "explain/PermutationImportance.h"
+#include "explain/WhatIf.h"
+#include <cctype>
+#include <cerrno>
+#include <fstream>
+#include <memory>
+#include <mutex>
 
 using namespace mlpack;
 
-int main() {
+// Index represents the Dimension. 
+// E.g "Senior Citizen" is in dimension 1. "Dependents" is in dimension 3
+const std::vector<std::string> dimensionToDataField = { 
+  "gender",
+  "SeniorCitizen",
+  "Partner",           
+  "Dependents",        
+  "tenure",            
+  "PhoneService",      
+  "MultipleLines",     
+  "InternetService",   
+  "OnlineSecurity",    
+  "OnlineBackup",      
+  "DeviceProtection",  
+  "TechSupport",       
+  "StreamingTV",       
+  "StreamingMovies",   
+  "Contract",         
+  "PaperlessBilling",  
+  "PaymentMethod",     
+  "MonthlyCharges",    
+  "TotalCharges"};
+
+// Identifies the model in prediction cache keys.
+enum CachedModel : uint32_t { LR_MODEL, DT_MODEL, NN_MODEL };
+
+// Reads a numeric query parameter into value if present.
+// Returns false if it is present but not a number.
+bool queryNumber(const crow::request &req, const char *name, double &value) {
+  const char *param = req.url_params.get(name);
+  if (!param)
+    return true;
+  char *end;
+  const double parsed = std::strtod(param, &end);
+  if (end == param || *end != '\0')
+    return false;
+  value = parsed;
+  return true;
+}
+
+// Reads an unsigned integer query parameter, such as a seed, into value if
+// present. Returns false if it is present but not a decimal integer that fits
+// in 64 bits.
+bool queryUnsigned(const crow::request &req, const char *name, uint64_t &value) {
+  const char *param = req.url_params.get(name);
+  if (!param)
+    return true;
+  if (!std::isdigit((unsigned char)*param))
+    return false;
+  char *end;
+  errno = 0;
+  const unsigned long long parsed = std::strtoull(param, &end, 10);
+  if (*end != '\0' || errno == ERANGE)
+    return false;
+  value = parsed;
+  return true;
+}
+
+// The models and encoders written by /generate and /load, for the
+// subcommands that run without the server.
+struct SavedModels {
+  LinearRegression lr;
+  DecisionTree<> dt;
+  FFN<MeanSquaredError, RandomInitialization> nn;
+  data::MinMaxScaler scalar;
+  data::DatasetInfo info;
+
+  SavedModels() {
+    data::Load("models/lr.bin", "lr", lr, true);
+    data::Load("models/dt.bin", "dt", dt, true);
+    data::Load("models/nn.bin", "nn", nn, true);
+    data::Load("data/scalar.bin", "scalar", scalar, true);
+    data::Load("data/dataset_info.bin", "info", info, true);
+  }
+};
+
+// The saved models behind a ModelSet, scored through the contribution tables
+// and the interpreted tree.
+struct SavedModelSet {
+  CategoricalEncoder encoder;
+  ModelSet models;
+
+  explicit SavedModelSet(SavedModels &saved)
+      : encoder(saved.info),
+        models(saved.scalar, false) {
+    models.Publish(std::make_shared<const ContributionTables>(
+        saved.lr, FFNWeights::Extract(saved.nn.Parameters()), saved.scalar, encoder));
+    models.PublishFlatTree(std::make_shared<const FlatTree>(
+        FlatTree::Build(saved.dt, encoder.Dimensionality())));
+  }
+};
+
+// ml-app.o score <input.csv> <output.csv> [--chunk-rows N] [--threads N]
+// Scores a CSV file with the saved models without starting the server.
+int scoreCommand(int argc, char **argv) {
+  const char *usage = "Usage: ml-app.o score <input.csv> <output.csv> [--chunk-rows N] [--threads N]\n";
+  if (argc < 4) {
+    std::cerr << usage;
+    return 1;
+  }
+
+  size_t chunkRows = 65536;
+  size_t threads = 0;
+  try {
+    for (int i = 4; i < argc; i += 2) {
+      std::string arg = argv[i];
+      if (arg == "--chunk-rows" && i + 1 < argc)
+        chunkRows = std::stoul(argv[i + 1]);
+      else if (arg == "--threads" && i + 1 < argc)
+        threads = std::stoul(argv[i + 1]);
+      else
+        throw std::invalid_argument(arg);
+    }
+  } catch (const std::logic_error &) {
+    std::cerr << usage;
+    return 1;
+  }
+
+  SavedModels saved;
+  CategoricalEncoder encoder(saved.info);
+  BatchScorer scorer(encoder, dimensionToDataField, saved.lr, saved.dt, saved.nn, saved.scalar, threads);
+  try {
+    BatchScorer::Summary summary = scorer.Score(argv[2], argv[3], std::max<size_t>(1, chunkRows));
+    std::cout << "Scored " << summary.rows << " rows (" << summary.rejected << " rejected) in "
+      << summary.seconds << "s, " << summary.rows / std::max(summary.seconds, 1e-9) << " rows/s" << '\n';
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
+
+// ml-app.o portfolio <customers.csv> [--model lr|dt|nn] [--by FIELD]
+//   [--ead-column NAME] [--lgd-column NAME] [--default-lgd X]
+//   [--chunk-rows N] [--threads N]
+// Expected loss of a customer file, per segment, with the saved models.
+int portfolioCommand(int argc, char **argv) {
+  const char *usage =
+    "Usage: ml-app.o portfolio <customers.csv> [--model lr|dt|nn] [--by FIELD]\n"
+    "         [--ead-column NAME] [--lgd-column NAME] [--default-lgd X] [--chunk-rows N] [--threads N]\n";
+  if (argc < 3) {
+    std::cerr << usage;
+    return 1;
+  }
+
+  PortfolioReader::PdModel model = PortfolioReader::PdModel::NN;
+  PortfolioReader::Columns columns;
+  int segmentField = -1;
+  size_t chunkRows = 65536;
+  size_t threads = 0;
+  try {
+    for (int i = 3; i < argc; i += 2) {
+      std::string arg = argv[i];
+      if (i + 1 >= argc)
+        throw std::invalid_argument(arg);
+      std::string value = argv[i + 1];
+      if (arg == "--model")
+        model = PortfolioReader::ParsePdModel(value);
+      else if (arg == "--by")
+        segmentField = PortfolioReader::ParseSegmentField(dimensionToDataField, value);
+      else if (arg == "--ead-column")
+        columns.ead = value;
+      else if (arg == "--lgd-column")
+        columns.lgd = value;
+      else if (arg == "--default-lgd")
+        columns.defaultLgd = std::stod(value);
+      else if (arg == "--chunk-rows")
+        chunkRows = std::max<size_t>(1, std::stoul(value));
+      else if (arg == "--threads")
+        threads = std::stoul(value);
+      else
+        throw std::invalid_argument(arg);
+    }
+  } catch (const std::logic_error &err) {
+    std::cerr << err.what() << '\n' << usage;
+    return 1;
+  }
+
+  SavedModels saved;
+  SavedModelSet scoring(saved);
+  PortfolioReader reader(scoring.encoder, dimensionToDataField, scoring.models, model, columns, segmentField, threads);
+  ExpectedLoss expectedLoss(reader.NumSegments(), threads);
+
+  std::ifstream in(argv[2]);
+  if (!in) {
+    std::cerr << "Cannot open " << argv[2] << '\n';
+    return 1;
+  }
+  size_t rejected = 0;
+  try {
+    reader.Read(in, chunkRows, [&](ExposureChunk const &chunk) { expectedLoss.Add(chunk); }, rejected);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << '\n';
+    return 1;
+  }
+  std::cout << expectedLoss.Report(reader, rejected);
+  return 0;
+}
+
+int simulateCommand(int argc, char **argv) {
+  const char *usage =
+    "Usage: ml-app.o simulate <customers.csv> [--model lr|dt|nn] [--scenarios N] [--rho R] [--seed S]\n"
+    "         [--confidence X] [--ead-column NAME] [--lgd-column NAME] [--default-lgd X]\n"
+    "         [--chunk-rows N] [--threads N]\n";
+  if (argc < 3) {
+    std::cerr << usage;
+    return 1;
+  }
+
+  PortfolioReader::PdModel model = PortfolioReader::PdModel::NN;
+  PortfolioReader::Columns columns;
+  MonteCarlo::Options simulation;
+  std::vector<double> levels = {0.99, 0.999};
+  size_t chunkRows = 65536;
+  try {
+    for (int i = 3; i < argc; i += 2) {
+      std::string arg = argv[i];
+      if (i + 1 >= argc)
+        throw std::invalid_argument(arg);
+      std::string value = argv[i + 1];
+      if (arg == "--model")
+        model = PortfolioReader::ParsePdModel(value);
+      else if (arg == "--scenarios")
+        simulation.scenarios = std::max<size_t>(1, std::stoul(value));
+      else if (arg == "--rho")
+        simulation.rho = std::stod(value);
+      else if (arg == "--seed")
+        simulation.seed = std::stoull(value);
+      else if (arg == "--confidence") {
+        const double level = std::stod(value);
+        if (level <= 0 || level >= 1)
+          throw std::invalid_argument(arg);
+        levels.push_back(level);
+      } else if (arg == "--ead-column")
+        columns.ead = value;
+      else if (arg == "--lgd-column")
+        columns.lgd = value;
+      else if (arg == "--default-lgd")
+        columns.defaultLgd = std::stod(value);
+      else if (arg == "--chunk-rows")
+        chunkRows = std::max<size_t>(1, std::stoul(value));
+      else if (arg == "--threads")
+        simulation.threads = std::stoul(value);
+      else
+        throw std::invalid_argument(arg);
+    }
+    if (simulation.rho <= 0 || simulation.rho >= 1)
+      throw std::invalid_argument("--rho must be in (0, 1)");
+  } catch (const std::logic_error &err) {
+    std::cerr << err.what() << '\n' << usage;
+    return 1;
+  }
+  std::sort(levels.begin(), levels.end());
+  levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+
+  SavedModels saved;
+  SavedModelSet scoring(saved);
+  PortfolioReader reader(scoring.encoder, dimensionToDataField, scoring.models, model, columns, -1, simulation.threads);
+  MonteCarlo monteCarlo;
+
+  std::ifstream in(argv[2]);
+  if (!in) {
+    std::cerr << "Cannot open " << argv[2] << '\n';
+    return 1;
+  }
+  size_t rejected = 0;
+  try {
+    reader.Read(in, chunkRows, [&](ExposureChunk const &chunk) { monteCarlo.Add(chunk); }, rejected);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << '\n';
+    return 1;
+  }
+  std::cout << MonteCarlo::Report(monteCarlo.Run(simulation, levels))
+    << '\n' << "rejected rows: " << rejected << '\n';
+  return 0;
+}
+
+int main(int argc, char **argv) {
+
+  if (argc > 1 && std::string(argv[1]) == "score")
+    return scoreCommand(argc, argv);
+  if (argc > 1 && std::string(argv[1]) == "portfolio")
+    return portfolioCommand(argc, argv);
+  if (argc > 1 && std::string(argv[1]) == "simulate")
+    return simulateCommand(argc, argv);
+
+  ServerOptions options;
+  try {
+    options = ServerOptions::Parse(argc, argv);
+  } catch (const std::invalid_argument &err) {
+    std::cerr << err.what() << '\n' << ServerOptions::Usage();
+    return 1;
+  }
  
   LinearRegression lr;
   DecisionTree<> dt;
@@ -16,85 +337,360 @@ int main() {
   data::MinMaxScaler scalar;
   data::Load("data/scalar.bin", "scalar", scalar);
 
-  arma::mat dataset;  
+  TrainingData trainingData("data/cleaned_credit_data.csv", scalar);
+
   data::DatasetInfo info;
-  data::Load("data/cleaned_credit_data.csv", dataset, info);
-  
-  ModelGenerator modelGenerator(dataset); 
-
-  // Index represents the Dimension. 
-  // E.g "Senior Citizen" is in dimension 1. "Dependents" is in dimension 3
-  std::vector<std::string> dimensionToDataField = { 
-    "gender",
-    "SeniorCitizen",
-    "Partner",           
-    "Dependents",        
-    "tenure",            
-    "PhoneService",      
-    "MultipleLines",     
-    "InternetService",   
-    "OnlineSecurity",    
-    "OnlineBackup",      
-    "DeviceProtection",  
-    "TechSupport",       
-    "StreamingTV",       
-    "StreamingMovies",   
-    "Contract",         
-    "PaperlessBilling",  
-    "PaymentMethod",     
-    "MonthlyCharges",    
-    "TotalCharges"};
-  
-  PredictRequestDeserializer deserializer(info, dimensionToDataField);
+  if (options.servingOnly) {
+    // Everything needed to predict comes from files written by /generate and /load.
+    data::Load("data/dataset_info.bin", "info", info, true);
+    data::Load("models/lr.bin", "lr", lr, true);
+    data::Load("models/dt.bin", "dt", dt, true);
+    data::Load("models/nn.bin", "nn", nn, true);
+  } else {
+    info = trainingData.Info();
+  }
+
+  // Single-precision models, served under /f32 when started with --f32. Every
+  // load builds a new set and swaps it in, like the explainer below.
+  std::shared_ptr<const Float32Models> float32Models;
+  auto loadFloat32Models = [&]() {
+    auto models = std::make_shared<Float32Models>();
+    models->SetLinearRegression(lr);
+    if (options.float32) {
+      FloatFFN floatNN;
+      if (options.servingOnly)
+        data::Load("models/nn_f32.bin", "nn", floatNN, true);
+      else
+        trainingData.Generator().generateBaseFNN32(floatNN);
+      models->SetNetwork(floatNN, scalar);
+    }
+    std::atomic_store(&float32Models, std::shared_ptr<const Float32Models>(models));
+  };
+  PredictRequestDeserializer deserializer(
+      info, dimensionToDataField, options.unknownCategory, options.unknownSentinel);
+
+  ModelSet allModels(scalar, options.nnInt8);
+
+  // Int8 copy of the network, calibrated on the scaled training data. Without
+  // the training data (serving-only) ranges are bounded from the weights.
+  // Every load quantizes a new copy and publishes it to allModels.
+  auto quantizeNN = [&]() {
+    auto quantized = std::make_shared<QuantizedFFN>();
+    quantized->Quantize(nn, options.servingOnly ? arma::mat() : trainingData.ScaledX());
+    allModels.PublishNetwork(quantized);
+  };
+
+  // Lookup tables for the /lr and /nn predict routes. Every load builds a new
+  // set for the model version it installs and publishes it to allModels.
+  auto buildContributionTables = [&](uint64_t version) {
+    allModels.Publish(std::make_shared<const ContributionTables>(
+        lr, FFNWeights::Extract(nn.Parameters()), scalar, deserializer.Encoder(), version));
+  };
+
+  // The decision tree flattened, and with --dt-codegen also as generated C++,
+  // compiled and loaded. Every load builds new ones and publishes them to
+  // allModels. Without a working compiler the flattened tree is served.
+  auto buildTrees = [&]() {
+    auto flat = std::make_shared<const FlatTree>(FlatTree::Build(dt, dimensionToDataField.size()));
+    allModels.PublishFlatTree(flat);
+    if (!options.dtCodegen)
+      return;
+    try {
+      auto tree = std::make_shared<GeneratedTree>();
+      tree->Build(*flat, dimensionToDataField, "models/dt.bin", "models/dt_gen");
+      allModels.PublishTree(tree);
+    } catch (const std::runtime_error &err) {
+      allModels.PublishTree(nullptr);
+      std::cerr << err.what() << "; serving the flattened decision tree" << '\n';
+    }
+  };
+  Cascade cascade(allModels, options.cascadeModel, options.cascadeLow, options.cascadeHigh);
+
+  // SHAP explanations against the training data, shared by the explain and
+  // what-if routes. Every load builds a new Explainer from the models it has
+  // just loaded and publishes it, so requests never copy a model mid-load.
+  std::shared_ptr<const Explainer> explainer;
+  auto buildExplainer = [&](uint64_t version) {
+    std::shared_ptr<const Explainer> built;
+    try {
+      built = std::make_shared<const Explainer>(
+        lr, dt, FFNWeights::Extract(nn.Parameters()), scalar, trainingData.X(), version);
+    } catch (const std::runtime_error &err) {
+      std::cerr << err.what() << "; explanations are unavailable" << '\n';
+    }
+    std::atomic_store(&explainer, built);
+  };
 
-  arma::mat dataX = dataset.submat(0, 0, dataset.n_rows - 2, dataset.n_cols - 1);
-  arma::mat dataY = dataset.row(dataset.n_rows - 1);
-  arma::mat scaledX;
-  scalar.Transform(dataX, scaledX);
+  if (options.servingOnly) {
+    loadFloat32Models();
+    quantizeNN();
+    buildContributionTables(0);
+    buildTrees();
+    buildExplainer(0);
+  }
 
-  crow::SimpleApp app;
+  // Per-route admission control. Cheap predict routes get a wide adaptive
+  // window; the expensive routes are capped so they cannot starve them.
+  ConcurrencyLimiter lrPredictLimiter("lr/predict", 32, 4, 256, std::chrono::milliseconds(5));
+  ConcurrencyLimiter dtPredictLimiter("dt/predict", 32, 4, 256, std::chrono::milliseconds(5));
+  ConcurrencyLimiter nnPredictLimiter("nn/predict", 32, 4, 256, std::chrono::milliseconds(5));
+  ConcurrencyLimiter allPredictLimiter("predict/all", 32, 4, 256, std::chrono::milliseconds(20));
+  ConcurrencyLimiter cascadePredictLimiter("cascade/predict", 32, 4, 256, std::chrono::milliseconds(5));
+  ConcurrencyLimiter explainLimiter("explain", 16, 2, 128, std::chrono::milliseconds(50));
+  // A what-if request holds at most ~9 MB (its customers, its scores and one
+  // expanded block), so the cap keeps them under ~150 MB together.
+  ConcurrencyLimiter whatIfLimiter("whatif", 8, 1, 16, std::chrono::milliseconds(200));
+  ConcurrencyLimiter statsLimiter("stats", 1, 1, 2, std::chrono::milliseconds(2000));
+  ConcurrencyLimiter adminLimiter("generate/load", 1, 1, 1, std::chrono::milliseconds(60000));
+
+  // Bumped on every /load so cached responses from older models are never served.
+  std::atomic<uint64_t> modelVersion(0);
+  PredictionCache predictionCache(options.cacheEntries);
+
+  // Raw scores on the training data: the linear model's and the network's
+  // outputs, and the decision tree's leaf probability of the positive class.
+  // Scored by the published explainer's copies of the models, which unlike
+  // FFN::Predict are const and are not overwritten by /load.
+  auto trainingScores = [&](Explainer const &models, const std::string &model) {
+    arma::rowvec scores;
+    if (model == "lr")
+      models.ScoreLinear(trainingData.X(), scores);
+    else if (model == "nn")
+      models.ScoreNetwork(trainingData.X(), scores);
+    else
+      models.ScoreTree(trainingData.X(), scores);
+    return scores;
+  };
+
+  // Per-segment metrics for the stats routes' ?by=Field1,Field2.
+  GroupedEvaluator groupedEvaluator(deserializer.Encoder(), dimensionToDataField);
+  auto appendGroupedStats = [&](const crow::request &req, const arma::rowvec &scores, std::string &eval) {
+    if (const char *by = req.url_params.get("by"))
+      eval += '\n' + groupedEvaluator.Report(
+          trainingData.X(), scores, trainingData.Y(), groupedEvaluator.ParseFields(by));
+  };
+
+  crow::App<CompressionThreshold> app;
+  app.get_middleware<CompressionThreshold>().minBytes = options.compressMinBytes;
 
   CROW_ROUTE(app, "/")([](){
     return "Customer Credit Risk Modelling";
   });
 
-  CROW_ROUTE(app, "/generate")([&modelGenerator](){
-    modelGenerator.generateBaseLinReg();
-    modelGenerator.generateBaseDT();
-    return "Models generated!";
+  CROW_ROUTE(app, "/generate")([&trainingData, &adminLimiter](){
+    auto permit = adminLimiter.tryAcquire();
+    if (!permit)
+      return crow::response(503, "Server busy");
+    trainingData.Generator().generateBaseLinReg();
+    trainingData.Generator().generateBaseDT();
+    trainingData.SaveInfo("data/dataset_info.bin");
+    return crow::response(200, "Models generated!");
   });
 
-  CROW_ROUTE(app, "/load")([&modelGenerator, &lr, &dt, &nn](){
+  CROW_ROUTE(app, "/load")([&](){
+    auto permit = adminLimiter.tryAcquire();
+    if (!permit)
+      return crow::response(503, "Server busy");
     data::Load("models/lr.bin", "lr", lr);
     data::Load("models/dt.bin", "dt", dt);
-    modelGenerator.generateBaseFNN(nn);
-    return "Models loaded!";
+    if (options.servingOnly)
+      data::Load("models/nn.bin", "nn", nn);
+    else
+      trainingData.Generator().generateBaseFNN(nn);
+    quantizeNN();
+    loadFloat32Models();
+    buildContributionTables(modelVersion + 1);
+    buildTrees();
+    buildExplainer(modelVersion + 1);
+    ++modelVersion;
+    return crow::response(200, "Models loaded!");
   });
 
-  CROW_ROUTE(app, "/lr/stats")([&](){
-    std::string eval = ModelEvaluator::Eval(lr, dataX, dataY); 
+  CROW_ROUTE(app, "/lr/stats")([&](const crow::request &req){
+    auto permit = statsLimiter.tryAcquire();
+    if (!permit)
+      return crow::response(503, "Server busy");
+    const std::shared_ptr<const Explainer> models = std::atomic_load(&explainer);
+    if (!models)
+      return crow::response(503, "Models not loaded");
+    arma::rowvec scores = trainingScores(*models, "lr");
+    arma::rowvec predY = round(scores);
+    std::string eval = ModelEvaluator::ClassificationReport(predY, trainingData.Y())
+      + '\n' + RankMetrics::Compute(scores, trainingData.Y()).Report();
+    try {
+      appendGroupedStats(req, scores, eval);
+    } catch (const std::invalid_argument &err) {
+      return crow::response(400, err.what());
+    }
     return crow::response(200, eval);
   });
 
-  CROW_ROUTE(app, "/nn/stats")([&](){
-    std::string eval = ModelEvaluator::Eval(nn, scaledX, dataY); 
+  CROW_ROUTE(app, "/nn/stats")([&](const crow::request &req){
+    auto permit = statsLimiter.tryAcquire();
+    if (!permit)
+      return crow::response(503, "Server busy");
+    const std::shared_ptr<const Explainer> models = std::atomic_load(&explainer);
+    if (!models)
+      return crow::response(503, "Models not loaded");
+    arma::rowvec scores = trainingScores(*models, "nn");
+    arma::rowvec predY = round(scores);
+    std::string eval = ModelEvaluator::ClassificationReport(predY, trainingData.Y())
+      + '\n' + RankMetrics::Compute(scores, trainingData.Y()).Report();
+    try {
+      appendGroupedStats(req, scores, eval);
+    } catch (const std::invalid_argument &err) {
+      return crow::response(400, err.what());
+    }
     return crow::response(200, eval);
   });
   
-  CROW_ROUTE(app, "/dt/stats")([&](){
+  CROW_ROUTE(app, "/dt/stats")([&](const crow::request &req){
+    auto permit = statsLimiter.tryAcquire();
+    if (!permit)
+      return crow::response(503, "Server busy");
+    const std::shared_ptr<const Explainer> models = std::atomic_load(&explainer);
+    if (!models)
+      return crow::response(503, "Models not loaded");
+    // Leaf probabilities of the positive class rank the customers.
     arma::Row<size_t> predictions;
-    dt.Classify(dataX, predictions);
-    arma::Row<size_t> trueY = arma::conv_to<arma::Row<size_t>>::from(dataY);
-    std::string eval = ModelEvaluator::ClassificationReport(predictions, trueY);
+    arma::rowvec scores;
+    models->ClassifyTree(trainingData.X(), predictions, scores);
+    arma::Row<size_t> trueY = arma::conv_to<arma::Row<size_t>>::from(trainingData.Y());
+    std::string eval = ModelEvaluator::ClassificationReport(predictions, trueY)
+      + '\n' + RankMetrics::Compute(scores, trainingData.Y()).Report();
+    try {
+      appendGroupedStats(req, scores, eval);
+    } catch (const std::invalid_argument &err) {
+      return crow::response(400, err.what());
+    }
     return crow::response(200, eval);
   });
 
+  // Confidence intervals for a model's metrics on the training data.
+  // ?resamples=N (default 2000) and ?confidence=C (default 0.95).
+  auto bootstrapResponse = [&](const crow::request &req, const std::string &model) {
+    auto permit = statsLimiter.tryAcquire();
+    if (!permit)
+      return crow::response(503, "Server busy");
+    double resamples = 2000, confidence = 0.95;
+    if (!queryNumber(req, "resamples", resamples) || resamples < 1 || resamples > 100000)
+      return crow::response(400, "Invalid resamples");
+    if (!queryNumber(req, "confidence", confidence) || confidence <= 0 || confidence >= 1)
+      return crow::response(400, "Invalid confidence");
+
+    const std::shared_ptr<const Explainer> models = std::atomic_load(&explainer);
+    if (!models)
+      return crow::response(503, "Models not loaded");
+    Bootstrap bootstrap(trainingScores(*models, model), trainingData.Y());
+    std::vector<Bootstrap::Interval> intervals = bootstrap.Run((size_t)resamples, confidence);
+    return crow::response(200, Bootstrap::Report(intervals, (size_t)resamples, confidence));
+  };
+
+  CROW_ROUTE(app, "/lr/bootstrap")([&](const crow::request &req){
+    return bootstrapResponse(req, "lr");
+  });
+
+  CROW_ROUTE(app, "/dt/bootstrap")([&](const crow::request &req){
+    return bootstrapResponse(req, "dt");
+  });
+
+  CROW_ROUTE(app, "/nn/bootstrap")([&](const crow::request &req){
+    return bootstrapResponse(req, "nn");
+  });
+
+  // The cutoff with the best expected value under ?tp=&fp=&tn=&fn= (value of
+  // each outcome per customer), optionally the cutoff for ?approval=rate, and
+  // the precision-recall curve at ?curve=N cutoffs (default 100, 0 for all).
+  auto thresholdResponse = [&](const crow::request &req, const std::string &model) {
+    auto permit = statsLimiter.tryAcquire();
+    if (!permit)
+      return crow::response(503, "Server busy");
+    ThresholdOptimizer::Values values;
+    double approval = -1, curve = 100;
+    if (!queryNumber(req, "tp", values.tp) || !queryNumber(req, "fp", values.fp) ||
+        !queryNumber(req, "tn", values.tn) || !queryNumber(req, "fn", values.fn))
+      return crow::response(400, "Invalid outcome value");
+    if (!queryNumber(req, "approval", approval) || (req.url_params.get("approval") && (approval < 0 || approval > 1)))
+      return crow::response(400, "Invalid approval");
+    // At most one cutoff per training row; also keeps the cast below defined.
+    if (!queryNumber(req, "curve", curve) || !(curve >= 0 && curve <= trainingData.Y().n_elem))
+      return crow::response(400, "Invalid curve");
+
+    const std::shared_ptr<const Explainer> models = std::atomic_load(&explainer);
+    if (!models)
+      return crow::response(503, "Models not loaded");
+    ThresholdOptimizer optimizer(trainingScores(*models, model), trainingData.Y());
+    return crow::response(200, optimizer.Report(values, approval, (size_t)curve));
+  };
+
+  CROW_ROUTE(app, "/lr/threshold")([&](const crow::request &req){
+    return thresholdResponse(req, "lr");
+  });
+
+  CROW_ROUTE(app, "/dt/threshold")([&](const crow::request &req){
+    return thresholdResponse(req, "dt");
+  });
+
+  CROW_ROUTE(app, "/nn/threshold")([&](const crow::request &req){
+    return thresholdResponse(req, "nn");
+  });
+
+  // Drop in ROC-AUC and accuracy on the training data when each field is
+  // shuffled, averaged over ?repeats= (default 5) shuffles drawn from ?seed=.
+  auto importanceResponse = [&](const crow::request &req, const std::string &model) {
+    auto permit = statsLimiter.tryAcquire();
+    if (!permit)
+      return crow::response(503, "Server busy");
+    if (!allModels.Ready())
+      return crow::response(503, "Models not loaded");
+    double repeats = 5;
+    uint64_t seed = 42;
+    if (!queryNumber(req, "repeats", repeats) || !(repeats >= 1 && repeats <= 100))
+      return crow::response(400, "Invalid repeats");
+    if (!queryUnsigned(req, "seed", seed))
+      return crow::response(400, "Invalid seed");
+
+    const ModelSet::Snapshot models = allModels.Current();
+    PermutationImportance::Scorer scorer;
+    if (model == "lr") {
+      scorer = [&](const double *x) { return models.LinearScore(x); };
+    } else if (model == "dt") {
+      scorer = [&](const double *x) {
+        double probability;
+        models.TreeClassify(x, probability);
+        return probability;
+      };
+    } else {
+      scorer = [&](const double *x) { return models.NetworkScore(x); };
+    }
+
+    PermutationImportance importance(scorer, trainingData.X(), trainingData.Y());
+    std::vector<PermutationImportance::Importance> importances =
+      importance.Run((size_t)repeats, seed);
+    return crow::response(200, importance.Report(importances, dimensionToDataField, (size_t)repeats));
+  };
+
+  CROW_ROUTE(app, "/lr/importance")([&](const crow::request &req){
+    return importanceResponse(req, "lr");
+  });
+
+  CROW_ROUTE(app, "/dt/importance")([&](const crow::request &req){
+    return importanceResponse(req, "dt");
+  });
+
+  CROW_ROUTE(app, "/nn/importance")([&](const crow::request &req){
+    return importanceResponse(req, "nn");
+  });
+
   CROW_ROUTE(app, "/lr/predict").methods(crow::HTTPMethod::POST)
   ([&](const crow::request &req){
+      auto permit = lrPredictLimiter.tryAcquire();
+      if (!permit)
+        return crow::response(503, "Server busy");
       auto body = crow::json::load(req.body);
       if (!body) 
         return crow::response(400, "Invalid body");
-      arma::colvec input(19);
+      double input[19];
       
       try {
         deserializer.convertRequestBodyToInput(body, input);
@@ -102,17 +698,31 @@ int main() {
         return crow::response(400, "Invalid body");
       }
 
-      arma::rowvec predictions;
-      lr.Predict(input, predictions);
+      // Cached under the version of the tables that score it.
+      const ModelSet::Snapshot models = allModels.Current();
+      const uint64_t version = models.Version();
+      std::string cached;
+      if (predictionCache.lookup(LR_MODEL, version, input, 19, cached))
+        return crow::response(200, cached);
+
+      arma::rowvec predictions(1);
+      if (models.Ready())
+        predictions(0) = models.LinearScore(input);
+      else
+        lr.Predict(arma::colvec(input, 19), predictions);
       std::ostringstream response;
       response << "Predictions: " << predictions << '\n';
 
+      predictionCache.insert(LR_MODEL, version, input, 19, response.str());
       return crow::response(200, response.str());
   });
   
   
   CROW_ROUTE(app, "/dt/predict").methods(crow::HTTPMethod::POST)
   ([&](const crow::request &req){
+      auto permit = dtPredictLimiter.tryAcquire();
+      if (!permit)
+        return crow::response(503, "Server busy");
       auto body = crow::json::load(req.body);
       if (!body) 
         return crow::response(400, "Invalid body");
@@ -124,17 +734,465 @@ int main() {
         return crow::response(400, "Invalid body");
       }
 
-      arma::Row<size_t> predictions;
-      dt.Classify(input, predictions);
+      const ModelSet::Snapshot models = allModels.Current();
+      const uint64_t version = models.Version();
+      std::string cached;
+      if (predictionCache.lookup(DT_MODEL, version, input.memptr(), input.n_elem, cached))
+        return crow::response(200, cached);
+
+      arma::Row<size_t> predictions(1);
+      double probability;
+      if (models.Ready())
+        predictions(0) = models.TreeClassify(input.memptr(), probability);
+      else
+        dt.Classify(input, predictions);
       std::ostringstream response;
       response << "Predictions: " << predictions << '\n';
 
+      predictionCache.insert(DT_MODEL, version, input.memptr(), input.n_elem, response.str());
       return crow::response(200, response.str());
   });
 
 
   CROW_ROUTE(app, "/nn/predict").methods(crow::HTTPMethod::POST)
   ([&](const crow::request &req){
+      auto permit = nnPredictLimiter.tryAcquire();
+      if (!permit)
+        return crow::response(503, "Server busy");
+      auto body = crow::json::load(req.body);
+      if (!body) 
+        return crow::response(400, "Invalid body");
+      double input[19];
+      
+      try {
+        deserializer.convertRequestBodyToInput(body, input);
+      } catch (const std::runtime_error &err) {
+        return crow::response(400, "Invalid body");
+      }
+
+      const ModelSet::Snapshot models = allModels.Current();
+      const uint64_t version = models.Version();
+      std::string cached;
+      if (predictionCache.lookup(NN_MODEL, version, input, 19, cached))
+        return crow::response(200, cached);
+
+      arma::rowvec predictions(1);
+      if (models.Ready()) {
+        predictions(0) = models.NetworkScore(input);
+      } else {
+        arma::colvec scaledInput;
+        scalar.Transform(arma::colvec(input, 19), scaledInput);
+        const std::shared_ptr<const QuantizedFFN> quantizedNN = allModels.QuantizedNN();
+        if (options.nnInt8 && quantizedNN)
+          quantizedNN->Predict(scaledInput, predictions);
+        else
+          nn.Predict(scaledInput, predictions);
+      }
+      std::ostringstream response;
+      response << "Predictions: " << predictions << '\n';
+
+      predictionCache.insert(NN_MODEL, version, input, 19, response.str());
+      return crow::response(200, response.str());
+  });
+
+  // Per-field contributions to one customer's score, sorted from the field
+  // raising it most; ?top=N keeps the first N. The network's are sampled
+  // from ?permutations= (default 64) with ?seed=.
+  auto explainResponse = [&](const crow::request &req, const std::string &model) {
+    auto permit = explainLimiter.tryAcquire();
+    if (!permit)
+      return crow::response(503, "Server busy");
+    if (!allModels.Ready())
+      return crow::response(503, "Models not loaded");
+    auto body = crow::json::load(req.body);
+    if (!body)
+      return crow::response(400, "Invalid body");
+    double top = 0, permutations = 64;
+    uint64_t seed = 42;
+    // More than every field is the same as all of them (0).
+    if (!queryNumber(req, "top", top) || !(top >= 0))
+      return crow::response(400, "Invalid top");
+    top = std::min(top, (double)dimensionToDataField.size());
+    if (!queryNumber(req, "permutations", permutations) ||
+        !(permutations >= 2 && permutations <= Explainer::MAX_PERMUTATIONS))
+      return crow::response(400, "Invalid permutations");
+    if (!queryUnsigned(req, "seed", seed))
+      return crow::response(400, "Invalid seed");
+
+    double input[19];
+    try {
+      deserializer.convertRequestBodyToInput(body, input);
+    } catch (const std::runtime_error &err) {
+      return crow::response(400, "Invalid body");
+    }
+
+    const std::shared_ptr<const Explainer> current = std::atomic_load(&explainer);
+    if (!current)
+      return crow::response(503, "Models not loaded");
+    Explanation explanation;
+    if (model == "lr")
+      explanation = current->Linear(input);
+    else if (model == "dt")
+      explanation = current->Tree(input);
+    else
+      explanation = current->Network(input, (size_t)permutations, seed);
+
+    std::string json;
+    Explainer::AppendJson(json, explanation, dimensionToDataField, (size_t)top);
+    crow::response res(200, json);
+    res.set_header("Content-Type", "application/json");
+    return res;
+  };
+
+  CROW_ROUTE(app, "/lr/explain").methods(crow::HTTPMethod::POST)
+  ([&](const crow::request &req){
+    return explainResponse(req, "lr");
+  });
+
+  CROW_ROUTE(app, "/dt/explain").methods(crow::HTTPMethod::POST)
+  ([&](const crow::request &req){
+    return explainResponse(req, "dt");
+  });
+
+  CROW_ROUTE(app, "/nn/explain").methods(crow::HTTPMethod::POST)
+  ([&](const crow::request &req){
+    return explainResponse(req, "nn");
+  });
+
+  // The score as ?field= sweeps ?points= values from ?from= to ?to= (or every
+  // category), for the customer object or array posted as the body. With an
+  // empty body, for ?sample= customers spread evenly over the training data.
+  auto whatIfResponse = [&](const crow::request &req, const std::string &model) {
+    auto permit = whatIfLimiter.tryAcquire();
+    if (!permit)
+      return crow::response(503, "Server busy");
+    if (!allModels.Ready())
+      return crow::response(503, "Models not loaded");
+    const char *field = req.url_params.get("field");
+    if (!field)
+      return crow::response(400, "Missing field");
+    double from = std::numeric_limits<double>::quiet_NaN();
+    double to = from, points = 50, sample = 1000;
+    if (!queryNumber(req, "from", from) || !queryNumber(req, "to", to))
+      return crow::response(400, "Invalid range");
+    if (!queryNumber(req, "points", points) || points < 1 || points > WhatIf::MAX_POINTS)
+      return crow::response(400, "Invalid points");
+    if (!queryNumber(req, "sample", sample) || sample < 1 || sample > WhatIf::MAX_CUSTOMERS)
+      return crow::response(400, "Invalid sample");
+
+    arma::mat customers;
+    if (req.body.empty()) {
+      const arma::mat &data = trainingData.X();
+      const size_t count = std::min<size_t>((size_t)sample, data.n_cols);
+      customers.set_size(data.n_rows, count);
+      for (size_t c = 0; c < count; ++c)
+        customers.col(c) = data.col(c * data.n_cols / count);
+    } else {
+      auto body = crow::json::load(req.body);
+      if (!body)
+        return crow::response(400, "Invalid body");
+      const bool batch = body.t() == crow::json::type::List;
+      const size_t rows = batch ? body.size() : 1;
+      customers.set_size(dimensionToDataField.size(), rows);
+      try {
+        for (size_t i = 0; i < rows; ++i)
+          deserializer.convertRequestBodyToInput(batch ? body[i] : body, customers.colptr(i));
+      } catch (const std::runtime_error &err) {
+        return crow::response(400, "Invalid body");
+      }
+    }
+
+    // Scored by the models of the current version's explainer; the live
+    // models are replaced in place by /load.
+    std::shared_ptr<const Explainer> current = std::atomic_load(&explainer);
+    if (!current)
+      return crow::response(503, "Models not loaded");
+    WhatIf whatIf(deserializer.Encoder(), dimensionToDataField, std::move(current));
+    std::string json;
+    try {
+      WhatIf::Grid grid = whatIf.MakeGrid(field, from, to, (size_t)points);
+      whatIf.AppendJson(json, grid, whatIf.Run(PortfolioReader::ParsePdModel(model), customers, grid));
+    } catch (const std::invalid_argument &err) {
+      return crow::response(400, err.what());
+    }
+    crow::response res = crow::response(200, std::move(json));
+    res.set_header("Content-Type", "application/json");
+    return res;
+  };
+
+  CROW_ROUTE(app, "/lr/whatif").methods(crow::HTTPMethod::POST)
+  ([&](const crow::request &req){
+    return whatIfResponse(req, "lr");
+  });
+
+  CROW_ROUTE(app, "/dt/whatif").methods(crow::HTTPMethod::POST)
+  ([&](const crow::request &req){
+    return whatIfResponse(req, "dt");
+  });
+
+  CROW_ROUTE(app, "/nn/whatif").methods(crow::HTTPMethod::POST)
+  ([&](const crow::request &req){
+    return whatIfResponse(req, "nn");
+  });
+
+  // Expected loss of a customer CSV posted as the body. Takes the portfolio
+  // subcommand's options as ?model=, ?by=, ?ead=, ?lgd= and ?default_lgd=.
+  CROW_ROUTE(app, "/portfolio/el").methods(crow::HTTPMethod::POST)
+  ([&](const crow::request &req){
+      auto permit = statsLimiter.tryAcquire();
+      if (!permit)
+        return crow::response(503, "Server busy");
+      if (!allModels.Ready())
+        return crow::response(503, "Models not loaded");
+
+      PortfolioReader::PdModel model = PortfolioReader::PdModel::NN;
+      PortfolioReader::Columns columns;
+      int segmentField = -1;
+      try {
+        if (const char *param = req.url_params.get("model"))
+          model = PortfolioReader::ParsePdModel(param);
+        if (const char *param = req.url_params.get("by"))
+          segmentField = PortfolioReader::ParseSegmentField(dimensionToDataField, param);
+      } catch (const std::invalid_argument &err) {
+        return crow::response(400, err.what());
+      }
+      if (const char *param = req.url_params.get("ead"))
+        columns.ead = param;
+      if (const char *param = req.url_params.get("lgd"))
+        columns.lgd = param;
+      if (!queryNumber(req, "default_lgd", columns.defaultLgd) || columns.defaultLgd < 0 || columns.defaultLgd > 1)
+        return crow::response(400, "Invalid default_lgd");
+
+      PortfolioReader reader(deserializer.Encoder(), dimensionToDataField, allModels, model, columns, segmentField);
+      ExpectedLoss expectedLoss(reader.NumSegments());
+      std::istringstream in(req.body);
+      size_t rejected = 0;
+      try {
+        reader.Read(in, 65536, [&](ExposureChunk const &chunk) { expectedLoss.Add(chunk); }, rejected);
+      } catch (const std::runtime_error &err) {
+        return crow::response(400, err.what());
+      }
+      return crow::response(200, expectedLoss.Report(reader, rejected));
+  });
+
+  // Monte Carlo VaR and expected shortfall of a customer CSV posted as the
+  // body. Takes ?model=, ?scenarios= (at most 1000000), ?rho=, ?seed= and
+  // ?confidence=, plus the column options of /portfolio/el.
+  CROW_ROUTE(app, "/portfolio/var").methods(crow::HTTPMethod::POST)
+  ([&](const crow::request &req){
+      auto permit = statsLimiter.tryAcquire();
+      if (!permit)
+        return crow::response(503, "Server busy");
+      if (!allModels.Ready())
+        return crow::response(503, "Models not loaded");
+
+      PortfolioReader::PdModel model = PortfolioReader::PdModel::NN;
+      try {
+        if (const char *param = req.url_params.get("model"))
+          model = PortfolioReader::ParsePdModel(param);
+      } catch (const std::invalid_argument &err) {
+        return crow::response(400, err.what());
+      }
+      PortfolioReader::Columns columns;
+      if (const char *param = req.url_params.get("ead"))
+        columns.ead = param;
+      if (const char *param = req.url_params.get("lgd"))
+        columns.lgd = param;
+      if (!queryNumber(req, "default_lgd", columns.defaultLgd) || columns.defaultLgd < 0 || columns.defaultLgd > 1)
+        return crow::response(400, "Invalid default_lgd");
+
+      MonteCarlo::Options simulation;
+      double scenarios = 10000, confidence = 0;
+      if (!queryNumber(req, "scenarios", scenarios) || !(scenarios >= 1 && scenarios <= 1000000))
+        return crow::response(400, "Invalid scenarios");
+      if (!queryNumber(req, "rho", simulation.rho) || !(simulation.rho > 0 && simulation.rho < 1))
+        return crow::response(400, "Invalid rho");
+      if (!queryUnsigned(req, "seed", simulation.seed))
+        return crow::response(400, "Invalid seed");
+      if (!queryNumber(req, "confidence", confidence) || !(confidence >= 0 && confidence < 1))
+        return crow::response(400, "Invalid confidence");
+      simulation.scenarios = (size_t)scenarios;
+      std::vector<double> levels = {0.99, 0.999};
+      if (confidence > 0)
+        levels.push_back(confidence);
+      std::sort(levels.begin(), levels.end());
+      levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+
+      PortfolioReader reader(deserializer.Encoder(), dimensionToDataField, allModels, model, columns, -1);
+      MonteCarlo monteCarlo;
+      std::istringstream in(req.body);
+      size_t rejected = 0;
+      try {
+        reader.Read(in, 65536, [&](ExposureChunk const &chunk) { monteCarlo.Add(chunk); }, rejected);
+      } catch (const std::runtime_error &err) {
+        return crow::response(400, err.what());
+      }
+      std::ostringstream out;
+      out << MonteCarlo::Report(monteCarlo.Run(simulation, levels))
+        << '\n' << "rejected rows: " << rejected << '\n';
+      return crow::response(200, out.str());
+  });
+
+  // Re-scores the training data under the stress scenarios posted as the
+  // body, with ?model= (default nn) and ?cutoff= (default 0.5).
+  CROW_ROUTE(app, "/stress").methods(crow::HTTPMethod::POST)
+  ([&](const crow::request &req){
+      auto permit = statsLimiter.tryAcquire();
+      if (!permit)
+        return crow::response(503, "Server busy");
+      if (!allModels.Ready())
+        return crow::response(503, "Models not loaded");
+      auto body = crow::json::load(req.body);
+      if (!body)
+        return crow::response(400, "Invalid body");
+
+      PortfolioReader::PdModel model = PortfolioReader::PdModel::NN;
+      double cutoff = 0.5;
+      if (!queryNumber(req, "cutoff", cutoff) || cutoff < 0 || cutoff > 1)
+        return crow::response(400, "Invalid cutoff");
+      try {
+        if (const char *param = req.url_params.get("model"))
+          model = PortfolioReader::ParsePdModel(param);
+        StressEngine engine(deserializer.Encoder(), dimensionToDataField, allModels, model);
+        std::vector<Scenario> scenarios = engine.ParseScenarios(body);
+        return crow::response(
+          200, StressEngine::Report(engine.Run(trainingData.X(), scenarios, cutoff), cutoff));
+      } catch (const std::invalid_argument &err) {
+        return crow::response(400, err.what());
+      }
+  });
+
+  // One customer object, or an array of them, scored by every model.
+  const size_t WIDE_BATCH_ROWS = 4096;
+  std::mutex wideBatchMutex;
+  CROW_ROUTE(app, "/predict/all").methods(crow::HTTPMethod::POST)
+  ([&](const crow::request &req){
+      auto permit = allPredictLimiter.tryAcquire();
+      if (!permit)
+        return crow::response(503, "Server busy");
+      if (!allModels.Ready())
+        return crow::response(503, "Models not loaded");
+      auto body = crow::json::load(req.body);
+      if (!body)
+        return crow::response(400, "Invalid body");
+
+      const bool batch = body.t() == crow::json::type::List;
+      const size_t rows = batch ? body.size() : 1;
+      arma::mat input(dimensionToDataField.size(), rows);
+      try {
+        if (batch) {
+          for (size_t i = 0; i < rows; ++i)
+            deserializer.convertRequestBodyToInput(body[i], input.colptr(i));
+        } else {
+          deserializer.convertRequestBodyToInput(body, input.colptr(0));
+        }
+      } catch (const std::runtime_error &err) {
+        return crow::response(400, "Invalid body");
+      }
+
+      // Crow already runs a handler per core, so a batch is scored on the
+      // request thread. Only a large one also uses the other cores, and only
+      // one at a time, so concurrent requests cannot oversubscribe them.
+      std::unique_lock<std::mutex> wide(wideBatchMutex, std::defer_lock);
+      const size_t threads = rows >= WIDE_BATCH_ROWS && wide.try_lock() ? 0 : 1;
+      std::vector<ModelScores> scores;
+      allModels.Score(input, scores, threads);
+
+      std::string json;
+      json.reserve(rows * 96);
+      if (batch)
+        json += '[';
+      for (size_t i = 0; i < rows; ++i) {
+        if (i > 0)
+          json += ',';
+        ModelSet::AppendJson(json, scores[i]);
+      }
+      if (batch)
+        json += ']';
+
+      crow::response res = crow::response(200, std::move(json));
+      res.set_header("Content-Type", "application/json");
+      return res;
+  });
+
+  // Scores with the cheap model and escalates uncertain cases to the network.
+  CROW_ROUTE(app, "/cascade/predict").methods(crow::HTTPMethod::POST)
+  ([&](const crow::request &req){
+      auto permit = cascadePredictLimiter.tryAcquire();
+      if (!permit)
+        return crow::response(503, "Server busy");
+      if (!allModels.Ready())
+        return crow::response(503, "Models not loaded");
+      auto body = crow::json::load(req.body);
+      if (!body)
+        return crow::response(400, "Invalid body");
+      double input[19];
+
+      try {
+        deserializer.convertRequestBodyToInput(body, input);
+      } catch (const std::runtime_error &err) {
+        return crow::response(400, "Invalid body");
+      }
+
+      Cascade::Result result = cascade.Predict(input);
+      std::ostringstream response;
+      response << std::setprecision(17) << "{\"score\":" << result.score
+        << ",\"model\":\"" << (result.escalated ? "nn" : Cascade::CheapName(cascade.Cheap())) << "\"}";
+      crow::response res(200, response.str());
+      res.set_header("Content-Type", "application/json");
+      return res;
+  });
+
+  // Tunes the cascade band on the training data so that its accuracy stays
+  // within ?max_loss (default 0.002) of the network's, and installs it.
+  CROW_ROUTE(app, "/cascade/tune")([&](const crow::request &req){
+    auto permit = statsLimiter.tryAcquire();
+    if (!permit)
+      return crow::response(503, "Server busy");
+    if (!allModels.Ready())
+      return crow::response(503, "Models not loaded");
+    double maxLoss = 0.002;
+    if (!queryNumber(req, "max_loss", maxLoss) || maxLoss < 0)
+      return crow::response(400, "Invalid max_loss");
+
+    const std::shared_ptr<const Explainer> models = std::atomic_load(&explainer);
+    if (!models)
+      return crow::response(503, "Models not loaded");
+    arma::rowvec cheapScores = trainingScores(*models, Cascade::CheapName(cascade.Cheap()));
+    arma::rowvec nnScores = trainingScores(*models, "nn");
+
+    ModelEvaluator::CascadeBand band =
+      ModelEvaluator::TuneCascadeBand(cheapScores, nnScores, trainingData.Y(), maxLoss);
+    cascade.SetBand(band.low, band.high);
+    return crow::response(200, ModelEvaluator::CascadeReport(band));
+  });
+
+  CROW_ROUTE(app, "/nn/int8/stats")([&](){
+    auto permit = statsLimiter.tryAcquire();
+    if (!permit)
+      return crow::response(503, "Server busy");
+    const std::shared_ptr<const QuantizedFFN> quantizedNN = allModels.QuantizedNN();
+    const std::shared_ptr<const Explainer> models = std::atomic_load(&explainer);
+    if (!quantizedNN || !models)
+      return crow::response(503, "Models not loaded");
+
+    arma::rowvec nnScores = trainingScores(*models, "nn");
+    arma::rowvec quantizedScores;
+    quantizedNN->Predict(trainingData.ScaledX(), quantizedScores);
+
+    std::ostringstream out;
+    out << "Int8 kernel: " << QuantizedFFN::KernelName() << '\n' << '\n'
+      << ModelEvaluator::Eval(*quantizedNN, trainingData.ScaledX(), trainingData.Y()) << '\n'
+      << "Int8 vs float64" << '\n'
+      << ModelEvaluator::CompareScores(nnScores, quantizedScores, trainingData.Y());
+    return crow::response(200, out.str());
+  });
+
+  CROW_ROUTE(app, "/f32/lr/predict").methods(crow::HTTPMethod::POST)
+  ([&](const crow::request &req){
+      auto permit = lrPredictLimiter.tryAcquire();
+      if (!permit)
+        return crow::response(503, "Server busy");
       auto body = crow::json::load(req.body);
       if (!body) 
         return crow::response(400, "Invalid body");
@@ -146,17 +1204,98 @@ int main() {
         return crow::response(400, "Invalid body");
       }
 
-      arma::colvec scaledInput;
-      scalar.Transform(input, scaledInput);
+      const std::shared_ptr<const Float32Models> models = std::atomic_load(&float32Models);
+      if (!models)
+        return crow::response(503, "Models not loaded");
+      arma::frowvec predictions;
+      models->PredictLR(arma::conv_to<arma::fmat>::from(input), predictions);
+      std::ostringstream response;
+      response << "Predictions: " << predictions << '\n';
+
+      return crow::response(200, response.str());
+  });
+
+  CROW_ROUTE(app, "/f32/nn/predict").methods(crow::HTTPMethod::POST)
+  ([&](const crow::request &req){
+      auto permit = nnPredictLimiter.tryAcquire();
+      if (!permit)
+        return crow::response(503, "Server busy");
+      const std::shared_ptr<const Float32Models> models = std::atomic_load(&float32Models);
+      if (!models || !models->NetworkLoaded())
+        return crow::response(503, "Float32 network not loaded; start with --f32 and call /load");
+      auto body = crow::json::load(req.body);
+      if (!body) 
+        return crow::response(400, "Invalid body");
+      arma::colvec input(19);
+      
+      try {
+        deserializer.convertRequestBodyToInput(body, input);
+      } catch (const std::runtime_error &err) {
+        return crow::response(400, "Invalid body");
+      }
 
-      arma::rowvec predictions;
-      nn.Predict(scaledInput, predictions);
+      arma::frowvec predictions;
+      models->PredictNN(arma::conv_to<arma::fmat>::from(input), predictions);
       std::ostringstream response;
       response << "Predictions: " << predictions << '\n';
 
       return crow::response(200, response.str());
   });
 
+  // Accuracy of the float32 models against the double models on the training data.
+  CROW_ROUTE(app, "/f32/stats")([&](){
+    auto permit = statsLimiter.tryAcquire();
+    if (!permit)
+      return crow::response(503, "Server busy");
+
+    const std::shared_ptr<const Float32Models> models = std::atomic_load(&float32Models);
+    const std::shared_ptr<const Explainer> doubleModels = std::atomic_load(&explainer);
+    if (!models || !doubleModels)
+      return crow::response(503, "Models not loaded");
+
+    const arma::rowvec labels = trainingData.Y();
+    const arma::fmat floatX = arma::conv_to<arma::fmat>::from(trainingData.X());
+    std::ostringstream out;
+
+    arma::rowvec lrScores = trainingScores(*doubleModels, "lr");
+    arma::frowvec lrFloatScores;
+    models->PredictLR(floatX, lrFloatScores);
+    out << "Linear Regression (float32 vs float64)" << '\n'
+      << ModelEvaluator::CompareScores(lrScores, arma::conv_to<arma::rowvec>::from(lrFloatScores), labels)
+      << '\n';
+
+    if (models->NetworkLoaded()) {
+      arma::rowvec nnScores = trainingScores(*doubleModels, "nn");
+      arma::frowvec nnFloatScores;
+      models->PredictNN(floatX, nnFloatScores);
+      out << "Neural Network (float32 vs float64)" << '\n'
+        << ModelEvaluator::CompareScores(nnScores, arma::conv_to<arma::rowvec>::from(nnFloatScores), labels);
+    }
+    return crow::response(200, out.str());
+  });
+
+  CROW_ROUTE(app, "/metrics")([&](){
+    std::ostringstream out;
+    out << ConcurrencyLimiter::ReportHeader() << '\n'
+      << lrPredictLimiter.Report()
+      << dtPredictLimiter.Report()
+      << nnPredictLimiter.Report()
+      << allPredictLimiter.Report()
+      << cascadePredictLimiter.Report()
+      << explainLimiter.Report()
+      << whatIfLimiter.Report()
+      << statsLimiter.Report()
+      << adminLimiter.Report()
+      << '\n' << predictionCache.Report()
+      << '\n' << deserializer.UnknownValueReport()
+      << '\n' << cascade.Report();
+    return crow::response(200, out.str());
+  });
+
+#ifdef CROW_ENABLE_COMPRESSION
+  app.use_compression(crow::compression::algorithm::GZIP);
+#endif
+  app.timeout(static_cast<std::uint8_t>(options.keepAliveTimeout));
 
   app.port(3000).multithreaded().run();
   
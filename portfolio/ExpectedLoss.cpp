@@ -0,0 +1,89 @@
+#include "ExpectedLoss.h"
+
+#include <iomanip>
+#include <sstream>
+#include "../util/Parallel.h"
+
+namespace {
+
+const size_t GRAIN = 1 << 14;
+
+void add(ExpectedLoss::Totals &into, ExpectedLoss::Totals const &from) {
+  into.obligors += from.obligors;
+  into.ead += from.ead;
+  into.el += from.el;
+  into.pd += from.pd;
+  into.lgdEad += from.lgdEad;
+}
+
+double ratio(double numerator, double denominator) {
+  return denominator > 0 ? numerator / denominator : 0;
+}
+
+void writeRow(std::ostringstream &out, std::string const &name, ExpectedLoss::Totals const &totals) {
+  out << std::left << std::setw(24) << name << std::right
+    << std::setw(12) << (uint64_t)totals.obligors
+    << std::setprecision(6)
+    << std::setw(16) << totals.ead
+    << std::setw(16) << totals.el
+    << std::setprecision(4)
+    << std::setw(10) << ratio(totals.el, totals.ead)
+    << std::setw(10) << ratio(totals.pd, totals.obligors)
+    << std::setw(10) << ratio(totals.lgdEad, totals.ead) << '\n';
+}
+
+} // namespace
+
+ExpectedLoss::ExpectedLoss(size_t segments, size_t threads)
+    : segments(segments), threads(threads == 0 ? defaultThreadCount() : threads) {}
+
+void ExpectedLoss::Add(ExposureChunk const &chunk) {
+  const size_t n = chunk.Size();
+  std::vector<std::vector<Totals>> local(threads, std::vector<Totals>(segments.size()));
+  parallelFor(n, GRAIN, [&](size_t worker, size_t begin, size_t end) {
+    std::vector<Totals> &totals = local[worker];
+    const double *pd = chunk.pd.data();
+    const double *ead = chunk.ead.data();
+    const double *lgd = chunk.lgd.data();
+    const uint32_t *segment = chunk.segment.data();
+    for (size_t i = begin; i < end; ++i) {
+      Totals &t = totals[segment[i]];
+      const double lgdEad = lgd[i] * ead[i];
+      t.obligors += 1;
+      t.ead += ead[i];
+      t.el += pd[i] * lgdEad;
+      t.pd += pd[i];
+      t.lgdEad += lgdEad;
+    }
+  }, threads);
+
+  for (std::vector<Totals> const &totals : local) {
+    for (size_t s = 0; s < segments.size(); ++s)
+      add(segments[s], totals[s]);
+  }
+}
+
+ExpectedLoss::Totals ExpectedLoss::Portfolio() const {
+  Totals total;
+  for (Totals const &segment : segments)
+    add(total, segment);
+  return total;
+}
+
+std::string ExpectedLoss::Report(PortfolioReader const &reader, size_t rejected) const {
+  std::ostringstream out;
+  out << std::left << std::setw(24) << "segment" << std::right
+    << std::setw(12) << "obligors" << std::setw(16) << "EAD" << std::setw(16) << "EL"
+    << std::setw(10) << "EL/EAD" << std::setw(10) << "mean PD" << std::setw(10) << "LGD"
+    << '\n' << '\n';
+  if (segments.size() > 1) {
+    for (size_t s = 0; s < segments.size(); ++s) {
+      if (segments[s].obligors > 0)
+        writeRow(out, reader.SegmentName(s), segments[s]);
+    }
+    out << '\n';
+  }
+  writeRow(out, "portfolio", Portfolio());
+  out << '\n' << "rejected rows: " << rejected << '\n';
+  return out.str();
+}
@@ -0,0 +1,39 @@
+#ifndef MLPACK_PROJECT_EXPECTED_LOSS_H
+#define MLPACK_PROJECT_EXPECTED_LOSS_H
+
+#include <string>
+#include <vector>
+#include "PortfolioReader.h"
+
+// Portfolio expected loss, EL = PD x LGD x EAD, aggregated per segment.
+//
+// Chunks from a PortfolioReader are added as they are read, so memory does
+// not grow with the portfolio. Each chunk is reduced in parallel into
+// per-thread segment totals that are merged into the running totals.
+class ExpectedLoss {
+public:
+  struct Totals {
+    double obligors = 0;
+    double ead = 0;
+    double el = 0;
+    double pd = 0;        // Sum of PDs
+    double lgdEad = 0;    // Sum of LGD x EAD
+  };
+
+  ExpectedLoss(size_t segments, size_t threads = 0);
+
+  void Add(ExposureChunk const &chunk);
+
+  std::vector<Totals> const &Segments() const { return segments; }
+  Totals Portfolio() const;
+
+  // Per segment and overall: obligors, EAD, EL, EL / EAD, mean PD and
+  // EAD-weighted LGD. Empty segments are left out.
+  std::string Report(PortfolioReader const &reader, size_t rejected) const;
+
+private:
+  std::vector<Totals> segments;
+  size_t threads;
+};
+
+#endif // MLPACK_PROJECT_EXPECTED_LOSS_H
@@ -0,0 +1,66 @@
+#ifndef MLPACK_PROJECT_MONTE_CARLO_H
+#define MLPACK_PROJECT_MONTE_CARLO_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "PortfolioReader.h"
+
+// Credit VaR and expected shortfall of a portfolio by Monte Carlo simulation
+// of the one-factor Gaussian (Vasicek) model.
+//
+// Obligor i defaults in a scenario when sqrt(rho) Z + sqrt(1 - rho) e_i falls
+// below Phi^-1(PD_i), with Z the systematic factor shared by the scenario
+// and e_i idiosyncratic. Given Z, that happens with probability
+// Phi((Phi^-1(PD_i) - sqrt(rho) Z) / sqrt(1 - rho)), which is read from an
+// interpolated table of Phi and compared with a uniform draw.
+//
+// Obligors are held as float structure-of-arrays and processed in blocks.
+// One loop per block computes the conditional PD, draws the uniform from a
+// 32-bit counter-based hash keyed by the seed, scenario and obligor, and
+// writes the weight times a 0/1 default mask; a second adds those up in
+// eight float partial sums. GCC vectorises both at -O3 -march=x86-64-v2
+// (check with -fopt-info-vec). Block sums are added in double, in the same
+// order on any thread count. Losses go into per-thread histograms with the
+// sum of losses per bin. Quantiles come from the merged histogram, and
+// expected shortfall uses the bin sums, so no losses are stored.
+class MonteCarlo {
+public:
+  struct Options {
+    size_t scenarios = 100000;
+    double rho = 0.12;      // Asset correlation
+    uint64_t seed = 42;
+    size_t threads = 0;
+  };
+
+  struct Result {
+    size_t obligors;
+    size_t scenarios;
+    double exposure;        // Sum of LGD x EAD, the largest possible loss
+    double expectedLoss;    // Sum of PD x LGD x EAD
+    double meanLoss;        // Simulated
+    double seconds;
+    std::vector<double> levels;
+    std::vector<double> var;
+    std::vector<double> es;
+  };
+
+  // Takes the obligors of every chunk added.
+  void Add(ExposureChunk const &chunk);
+
+  size_t Obligors() const { return threshold.size(); }
+
+  // VaR and expected shortfall at each confidence level, e.g. 0.999.
+  Result Run(Options const &options, std::vector<double> const &levels) const;
+
+  static std::string Report(Result const &result);
+
+  static const size_t BINS = 1 << 16;
+
+private:
+  std::vector<double> threshold;  // Phi^-1(PD)
+  std::vector<double> weight;     // LGD x EAD
+  double expectedLoss = 0;
+};
+
+#endif // MLPACK_PROJECT_MONTE_CARLO_H
@@ -0,0 +1,197 @@
+#include "PortfolioReader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include "../util/Parallel.h"
+
+namespace {
+
+const size_t GRAIN = 1024;
+
+// Parses a whole field as a number.
+bool parseNumber(CsvField field, double &value) {
+  field = trimCsvField(field);
+  if (field.second == 0 || field.second > 63)
+    return false;
+  char buffer[64];
+  std::copy(field.first, field.first + field.second, buffer);
+  buffer[field.second] = '\0';
+  char *end;
+  value = std::strtod(buffer, &end);
+  return end == buffer + field.second && std::isfinite(value);
+}
+
+} // namespace
+
+const size_t PortfolioReader::MAX_NUMERIC_SEGMENTS;
+
+PortfolioReader::PortfolioReader(CategoricalEncoder const &encoder,
+                                 std::vector<std::string> const &fieldNames,
+                                 ModelSet const &models,
+                                 PdModel model,
+                                 Columns const &columns,
+                                 int segmentField,
+                                 size_t threads)
+    : encoder(encoder), fieldNames(fieldNames), models(models), model(model),
+      columns(columns), segmentField(segmentField), threads(threads),
+      eadColumn(0), lgdColumn(-1) {
+  if (fieldNames.size() > 64)
+    throw std::invalid_argument("Too many features");
+  if (segmentField < 0)
+    segments = 1;
+  else if (encoder.IsCategorical(segmentField))
+    segments = encoder.NumCategories(segmentField) + 1;  // Last: other values
+  else
+    segments = MAX_NUMERIC_SEGMENTS + 1;
+}
+
+PortfolioReader::PdModel PortfolioReader::ParsePdModel(std::string const &name) {
+  if (name == "lr")
+    return PdModel::LR;
+  if (name == "dt")
+    return PdModel::DT;
+  if (name == "nn")
+    return PdModel::NN;
+  throw std::invalid_argument("Unknown model: " + name + " (use lr, dt or nn)");
+}
+
+int PortfolioReader::ParseSegmentField(std::vector<std::string> const &fieldNames, std::string const &name) {
+  auto it = std::find(fieldNames.begin(), fieldNames.end(), name);
+  if (it == fieldNames.end())
+    throw std::invalid_argument("Unknown field: " + name);
+  return (int)(it - fieldNames.begin());
+}
+
+std::string PortfolioReader::SegmentName(size_t segment) const {
+  if (segmentField < 0)
+    return "all";
+  if (segment + 1 == segments)
+    return "other";
+  if (encoder.IsCategorical(segmentField))
+    return encoder.CategoryName(segmentField, segment);
+  return std::to_string(segment);
+}
+
+void PortfolioReader::readHeader(std::string const &line) {
+  std::vector<CsvField> fields;
+  splitCsvLine(line, fields);
+  auto find = [&](std::string const &name) -> long {
+    for (size_t col = 0; col < fields.size(); ++col) {
+      CsvField field = trimCsvField(fields[col]);
+      if (std::string(field.first, field.second) == name)
+        return (long)col;
+    }
+    return -1;
+  };
+
+  featureColumn.assign(fieldNames.size(), 0);
+  for (size_t dim = 0; dim < fieldNames.size(); ++dim) {
+    const long col = find(fieldNames[dim]);
+    if (col < 0)
+      throw std::runtime_error("Missing column " + fieldNames[dim]);
+    featureColumn[dim] = col;
+  }
+  const long ead = find(columns.ead);
+  if (ead < 0)
+    throw std::runtime_error("Missing column " + columns.ead);
+  eadColumn = ead;
+  lgdColumn = find(columns.lgd);
+}
+
+bool PortfolioReader::parseRow(std::string const &line, std::vector<CsvField> &fields,
+                               ModelSet::Snapshot const &snapshot, double &pd, double &ead, double &lgd, uint32_t &segment) const {
+  splitCsvLine(line, fields);
+  double x[64];
+  try {
+    for (size_t dim = 0; dim < fieldNames.size(); ++dim) {
+      if (featureColumn[dim] >= fields.size())
+        return false;
+      const CsvField field = trimCsvField(fields[featureColumn[dim]]);
+      x[dim] = encoder.Encode(dim, field.first, field.second);
+    }
+  } catch (const std::runtime_error &) {
+    return false;
+  }
+
+  if (eadColumn >= fields.size() || !parseNumber(fields[eadColumn], ead) || ead < 0)
+    return false;
+  lgd = columns.defaultLgd;
+  if (lgdColumn >= 0 && (size_t)lgdColumn < fields.size() && trimCsvField(fields[lgdColumn]).second > 0) {
+    if (!parseNumber(fields[lgdColumn], lgd) || lgd < 0 || lgd > 1)
+      return false;
+  }
+
+  if (model == PdModel::LR) {
+    pd = snapshot.LinearScore(x);
+  } else if (model == PdModel::DT) {
+    snapshot.TreeClassify(x, pd);
+  } else {
+    pd = snapshot.NetworkScore(x);
+  }
+  // The regression outputs are not bounded to [0, 1].
+  pd = std::min(1.0, std::max(0.0, pd));
+
+  segment = 0;
+  if (segmentField >= 0) {
+    const double value = x[segmentField];
+    const bool known = value >= 0 && value < segments - 1 && value == std::floor(value);
+    segment = known ? (uint32_t)value : (uint32_t)(segments - 1);
+  }
+  return true;
+}
+
+size_t PortfolioReader::Read(std::istream &in, size_t chunkRows,
+                             std::function<void(ExposureChunk const &)> const &sink,
+                             size_t &rejected) {
+  std::string header;
+  do {
+    if (!std::getline(in, header))
+      throw std::runtime_error("Missing header");
+  } while (header.empty() || header == "\r");
+  if (header.back() == '\r')
+    header.pop_back();
+  readHeader(header);
+
+  const size_t workers = threads == 0 ? defaultThreadCount() : threads;
+  // One set of models for the whole file, even if /load runs meanwhile.
+  const ModelSet::Snapshot snapshot = models.Current();
+  std::vector<std::vector<CsvField>> fieldScratch(workers);
+  std::vector<std::string> lines;
+  std::vector<char> valid;
+  ExposureChunk scored, chunk;
+  size_t total = 0;
+
+  for (size_t n; (n = readCsvLines(in, lines, chunkRows)) > 0;) {
+    scored.pd.resize(n);
+    scored.ead.resize(n);
+    scored.lgd.resize(n);
+    scored.segment.resize(n);
+    valid.assign(n, 0);
+    parallelFor(n, GRAIN, [&](size_t worker, size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i)
+        valid[i] = parseRow(lines[i], fieldScratch[worker], snapshot,
+                            scored.pd[i], scored.ead[i], scored.lgd[i], scored.segment[i]);
+    }, workers);
+
+    // Keep the valid rows only, in input order.
+    chunk.pd.clear();
+    chunk.ead.clear();
+    chunk.lgd.clear();
+    chunk.segment.clear();
+    for (size_t i = 0; i < n; ++i) {
+      if (!valid[i]) {
+        ++rejected;
+        continue;
+      }
+      chunk.pd.push_back(scored.pd[i]);
+      chunk.ead.push_back(scored.ead[i]);
+      chunk.lgd.push_back(scored.lgd[i]);
+      chunk.segment.push_back(scored.segment[i]);
+    }
+    total += n;
+    sink(chunk);
+  }
+  return total;
+}
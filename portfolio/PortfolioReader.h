@@ -0,0 +1,86 @@
+#ifndef MLPACK_PROJECT_PORTFOLIO_READER_H
+#define MLPACK_PROJECT_PORTFOLIO_READER_H
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+#include "../encoder/CategoricalEncoder.h"
+#include "../scoring/ModelSet.h"
+#include "../util/Csv.h"
+
+// Exposures of a block of customers as structure-of-arrays.
+struct ExposureChunk {
+  std::vector<double> pd;        // Probability of default from the model
+  std::vector<double> ead;       // Exposure at default
+  std::vector<double> lgd;       // Loss given default, as a fraction
+  std::vector<uint32_t> segment;
+
+  size_t Size() const { return pd.size(); }
+};
+
+// Streams a customer CSV in chunks and scores each customer's probability of
+// default with one of the loaded models.
+//
+// The file needs a header naming the 19 features and an exposure column. A
+// loss-given-default column is optional; without one every customer gets
+// the default LGD. Customers are segmented by one feature's categories (or
+// small integer values), or all fall in one segment. Rows that cannot be
+// encoded or parsed are counted and skipped.
+class PortfolioReader {
+public:
+  enum class PdModel { LR, DT, NN };
+
+  struct Columns {
+    std::string ead = "EAD";
+    std::string lgd = "LGD";
+    double defaultLgd = 0.45;
+  };
+
+  // segmentField is an index into fieldNames, or -1 for a single segment.
+  PortfolioReader(CategoricalEncoder const &encoder,
+                  std::vector<std::string> const &fieldNames,
+                  ModelSet const &models,
+                  PdModel model,
+                  Columns const &columns,
+                  int segmentField = -1,
+                  size_t threads = 0);
+
+  // Calls sink once per chunk of scored rows. Returns the number of rows
+  // read, and adds the skipped ones to `rejected`.
+  // Throws std::runtime_error if the header lacks a required column.
+  size_t Read(std::istream &in, size_t chunkRows, std::function<void(ExposureChunk const &)> const &sink,
+              size_t &rejected);
+
+  size_t NumSegments() const { return segments; }
+  std::string SegmentName(size_t segment) const;
+
+  // Throws std::invalid_argument for anything but "lr", "dt" or "nn".
+  static PdModel ParsePdModel(std::string const &name);
+
+  // Throws std::invalid_argument for an unknown field.
+  static int ParseSegmentField(std::vector<std::string> const &fieldNames, std::string const &name);
+
+  static const size_t MAX_NUMERIC_SEGMENTS = 256;
+
+private:
+  CategoricalEncoder const &encoder;
+  std::vector<std::string> fieldNames;
+  ModelSet const &models;
+  PdModel model;
+  Columns columns;
+  int segmentField;
+  size_t segments;
+  size_t threads;
+
+  std::vector<size_t> featureColumn;
+  size_t eadColumn;
+  long lgdColumn;
+
+  void readHeader(std::string const &line);
+  bool parseRow(std::string const &line, std::vector<CsvField> &fields, ModelSet::Snapshot const &snapshot,
+                double &pd, double &ead, double &lgd, uint32_t &segment) const;
+};
+
+#endif // MLPACK_PROJECT_PORTFOLIO_READER_H
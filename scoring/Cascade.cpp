@@ -0,0 +1,57 @@
+#include "Cascade.h"
+
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+Cascade::Cascade(ModelSet const &models, CheapModel cheap, double low, double high)
+    : models(models), cheap(cheap), band(std::make_shared<const Band>(Band{low, high})),
+      requests(0), escalated(0) {}
+
+Cascade::Result Cascade::Predict(const double *encoded) {
+  requests.fetch_add(1, std::memory_order_relaxed);
+
+  const ModelSet::Snapshot snapshot = models.Current();
+  Result result;
+  if (cheap == CheapModel::LR) {
+    result.score = snapshot.LinearScore(encoded);
+  } else {
+    snapshot.TreeClassify(encoded, result.score);
+  }
+
+  const std::shared_ptr<const Band> current = std::atomic_load(&band);
+  result.escalated = result.score >= current->low && result.score <= current->high;
+  if (result.escalated) {
+    escalated.fetch_add(1, std::memory_order_relaxed);
+    result.score = snapshot.NetworkScore(encoded);
+  }
+  return result;
+}
+
+const char *Cascade::CheapName(CheapModel cheap) {
+  return cheap == CheapModel::LR ? "lr" : "dt";
+}
+
+Cascade::CheapModel Cascade::ParseCheapModel(std::string const &name) {
+  if (name == "lr")
+    return CheapModel::LR;
+  if (name == "dt")
+    return CheapModel::DT;
+  throw std::invalid_argument("Unknown cascade model: " + name + " (use lr or dt)");
+}
+
+void Cascade::SetBand(double low, double high) {
+  std::atomic_store(&band, std::make_shared<const Band>(Band{low, high}));
+}
+
+std::string Cascade::Report() const {
+  const uint64_t total = requests.load();
+  const uint64_t up = escalated.load();
+  const std::shared_ptr<const Band> current = std::atomic_load(&band);
+  std::ostringstream out;
+  out << "cascade " << CheapName(cheap) << " -> nn, band [" << current->low << ", " << current->high << "]\n"
+    << std::left << std::setw(18) << "requests" << total << '\n'
+    << std::setw(18) << "escalated" << up << '\n'
+    << std::setw(18) << "escalation rate" << std::setprecision(3) << (total ? (double)up / total : 0.0) << '\n';
+  return out.str();
+}
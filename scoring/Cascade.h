@@ -0,0 +1,55 @@
+#ifndef MLPACK_PROJECT_CASCADE_H
+#define MLPACK_PROJECT_CASCADE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "ModelSet.h"
+
+// Two-tier scoring for /cascade/predict: a cheap model (the linear model or
+// the decision tree's leaf probability) scores every request, and only scores
+// inside the band [low, high] are escalated to the network.
+//
+// The band is set from the command line or tuned with
+// ModelEvaluator::TuneCascadeBand, and can be replaced while serving. Both
+// bounds live in one immutable Band swapped atomically, so a request never
+// sees the low bound of one band with the high bound of another.
+class Cascade {
+public:
+  enum class CheapModel { LR, DT };
+
+  struct Result {
+    double score;
+    bool escalated;
+  };
+
+  Cascade(ModelSet const &models, CheapModel cheap, double low, double high);
+
+  Result Predict(const double *encoded);
+
+  CheapModel Cheap() const { return cheap; }
+  static const char *CheapName(CheapModel cheap);
+
+  // Throws std::invalid_argument for anything but "lr" or "dt".
+  static CheapModel ParseCheapModel(std::string const &name);
+
+  void SetBand(double low, double high);
+
+  // Band, request count and escalation rate, for /metrics.
+  std::string Report() const;
+
+private:
+  struct Band {
+    double low;
+    double high;
+  };
+
+  ModelSet const &models;
+  CheapModel cheap;
+  std::shared_ptr<const Band> band;
+  std::atomic<uint64_t> requests;
+  std::atomic<uint64_t> escalated;
+};
+
+#endif // MLPACK_PROJECT_CASCADE_H
@@ -0,0 +1,129 @@
+#include "ContributionTables.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+ContributionTables::ContributionTables(LinearRegression const &lr,
+                                       FFNWeights const &weights,
+                                       data::MinMaxScaler const &scalar,
+                                       CategoricalEncoder const &encoder,
+                                       uint64_t version)
+    : version(version), dims(encoder.Dimensionality()), lrBase(0), hidden(0) {
+  categorical.assign(dims, 0);
+  categories.assign(dims, 0);
+  for (size_t i = 0; i < dims; ++i) {
+    categorical[i] = encoder.IsCategorical(i);
+    categories[i] = encoder.NumCategories(i);
+  }
+  buildLinear(lr);
+  buildNetwork(weights, scalar);
+}
+
+bool ContributionTables::inTable(size_t dim, double code) const {
+  return code >= 0 && code < categories[dim] && code == std::floor(code);
+}
+
+void ContributionTables::buildLinear(LinearRegression const &lr) {
+  const arma::vec &parameters = lr.Parameters();
+  const size_t first = lr.Intercept() ? 1 : 0;
+  if (parameters.n_elem != dims + first)
+    throw std::runtime_error("Linear model does not match the encoder dimensionality");
+
+  lrBase = lr.Intercept() ? parameters(0) : 0;
+  lrCoef.assign(parameters.begin() + first, parameters.end());
+  lrTable.assign(dims, std::vector<double>());
+  for (size_t i = 0; i < dims; ++i) {
+    for (size_t code = 0; code < categories[i]; ++code)
+      lrTable[i].push_back(lrCoef[i] * code);
+  }
+}
+
+void ContributionTables::buildNetwork(FFNWeights const &weights, data::MinMaxScaler const &scalar) {
+  if (weights.w1.n_cols != dims)
+    throw std::runtime_error("Network does not match the encoder dimensionality");
+
+  // data::MinMaxScaler maps x to (x - itemMin) * scale + scaleMin,
+  // i.e. scale * x + offset per field.
+  const arma::vec &itemMin = scalar.ItemMin();
+  const arma::vec &scale = scalar.Scale();
+  const double scaleMin = scalar.ScaleMin();
+
+  hidden = weights.w1.n_rows;
+  nnBase = arma::conv_to<std::vector<double>>::from(weights.b1);
+  nnCoef.assign(dims * hidden, 0);
+  nnOffset.assign(dims * hidden, 0);
+  nnTable.assign(dims, std::vector<double>());
+
+  for (size_t i = 0; i < dims; ++i) {
+    const double offset = scaleMin - itemMin(i) * scale(i);
+    for (size_t h = 0; h < hidden; ++h) {
+      nnCoef[i * hidden + h] = weights.w1(h, i) * scale(i);
+      nnOffset[i * hidden + h] = weights.w1(h, i) * offset;
+      if (!categorical[i])
+        nnBase[h] += nnOffset[i * hidden + h];
+    }
+    for (size_t code = 0; code < categories[i]; ++code) {
+      for (size_t h = 0; h < hidden; ++h)
+        nnTable[i].push_back(nnCoef[i * hidden + h] * code + nnOffset[i * hidden + h]);
+    }
+  }
+
+  rest = weights;
+}
+
+double ContributionTables::ScoreLR(const double *encoded) const {
+  double score = lrBase;
+  for (size_t i = 0; i < dims; ++i) {
+    if (categorical[i] && inTable(i, encoded[i]))
+      score += lrTable[i][(size_t)encoded[i]];
+    else
+      score += lrCoef[i] * encoded[i];
+  }
+  return score;
+}
+
+double ContributionTables::ScoreNN(const double *encoded) const {
+  double z1[64];
+  double z2[64];
+  if (hidden > 64 || rest.w2.n_rows > 64)
+    throw std::runtime_error("Network too wide for the contribution tables");
+
+  for (size_t h = 0; h < hidden; ++h)
+    z1[h] = nnBase[h];
+
+  for (size_t i = 0; i < dims; ++i) {
+    const double x = encoded[i];
+    if (categorical[i] && inTable(i, x)) {
+      const double *row = &nnTable[i][(size_t)x * hidden];
+      for (size_t h = 0; h < hidden; ++h)
+        z1[h] += row[h];
+    } else {
+      const double *coef = &nnCoef[i * hidden];
+      for (size_t h = 0; h < hidden; ++h)
+        z1[h] += coef[h] * x;
+      if (categorical[i]) {
+        const double *offset = &nnOffset[i * hidden];
+        for (size_t h = 0; h < hidden; ++h)
+          z1[h] += offset[h];
+      }
+    }
+  }
+
+  // FlexibleReLU, Linear(16), Sigmoid, Linear(1).
+  for (size_t h = 0; h < hidden; ++h)
+    z1[h] = std::max(0.0, z1[h]) + rest.alpha;
+
+  const size_t hidden2 = rest.w2.n_rows;
+  for (size_t r = 0; r < hidden2; ++r) {
+    double sum = rest.b2(r);
+    for (size_t h = 0; h < hidden; ++h)
+      sum += rest.w2(r, h) * z1[h];
+    z2[r] = 1.0 / (1.0 + std::exp(-sum));
+  }
+
+  double output = rest.b3;
+  for (size_t r = 0; r < hidden2; ++r)
+    output += rest.w3(r) * z2[r];
+  return output;
+}
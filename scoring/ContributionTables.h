@@ -0,0 +1,69 @@
+#ifndef MLPACK_PROJECT_CONTRIBUTION_TABLES_H
+#define MLPACK_PROJECT_CONTRIBUTION_TABLES_H
+
+#include <cstdint>
+#include <vector>
+#include <mlpack.hpp>
+#include "FFNWeights.h"
+#include "../encoder/CategoricalEncoder.h"
+
+using namespace mlpack;
+
+// Precomputed per-category contributions for the linear model and the first
+// layer of the network.
+//
+// Most request fields are categorical, and every category has a fixed code, so
+// the term w_i * x_i (or, for the network, the column W1(:, i) times the scaled
+// code) can be looked up instead of computed. Scoring then costs one table
+// lookup per categorical field and one multiply-add per numeric field. The
+// scaler's offsets for numeric fields and the biases are folded into a
+// constant. Codes outside a table, e.g. from the sentinel or count unknown
+// category policies, fall back to the multiply-add.
+//
+// A set of tables is built once per model load and never modified, so /load
+// builds new tables beside the ones being served and swaps them in (see
+// ModelSet::Publish).
+class ContributionTables {
+private:
+  uint64_t version;
+  size_t dims;
+  std::vector<char> categorical;
+  std::vector<size_t> categories;
+
+  // Linear regression: intercept, one coefficient per field, and
+  // coefficient * code for every category.
+  double lrBase;
+  std::vector<double> lrCoef;
+  std::vector<std::vector<double>> lrTable;
+
+  // First layer pre-activation, stored field-major with `hidden` values per
+  // field (or per category).
+  size_t hidden;
+  std::vector<double> nnBase;       // b1 + scaler offsets of numeric fields
+  std::vector<double> nnCoef;       // dims x hidden: W1(:, i) * scale_i
+  std::vector<double> nnOffset;     // dims x hidden: W1(:, i) * offset_i
+  std::vector<std::vector<double>> nnTable;  // per field: categories x hidden
+  FFNWeights rest;                  // Layers after the first
+
+  bool inTable(size_t dim, double code) const;
+  void buildLinear(LinearRegression const &lr);
+  void buildNetwork(FFNWeights const &weights, data::MinMaxScaler const &scalar);
+
+public:
+  // Throws std::runtime_error if a model does not match the encoder.
+  ContributionTables(LinearRegression const &lr,
+                     FFNWeights const &weights,
+                     data::MinMaxScaler const &scalar,
+                     CategoricalEncoder const &encoder,
+                     uint64_t version = 0);
+
+  // The model version the tables were built from.
+  uint64_t Version() const { return version; }
+  size_t Dimensionality() const { return dims; }
+
+  // Both take the unscaled encoded features of one request.
+  double ScoreLR(const double *encoded) const;
+  double ScoreNN(const double *encoded) const;
+};
+
+#endif // MLPACK_PROJECT_CONTRIBUTION_TABLES_H
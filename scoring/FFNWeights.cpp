@@ -0,0 +1,51 @@
+#include "FFNWeights.h"
+
+#include <stdexcept>
+
+namespace {
+
+const size_t HIDDEN1 = 32;
+const size_t HIDDEN2 = 16;
+
+} // namespace
+
+FFNWeights FFNWeights::Extract(const arma::mat &parameters) {
+  // Everything except the first layer's weight matrix has a fixed size.
+  const size_t fixed = HIDDEN1 + 1 + (HIDDEN2 * HIDDEN1 + HIDDEN2) + (HIDDEN2 + 1);
+  if (parameters.n_elem <= fixed || (parameters.n_elem - fixed) % HIDDEN1 != 0)
+    throw std::runtime_error("Unexpected network parameter count " + std::to_string(parameters.n_elem));
+  const size_t inputs = (parameters.n_elem - fixed) / HIDDEN1;
+
+  FFNWeights weights;
+  const double *p = parameters.memptr();
+
+  weights.w1 = arma::mat(p, HIDDEN1, inputs);
+  p += HIDDEN1 * inputs;
+  weights.b1 = arma::vec(p, HIDDEN1);
+  p += HIDDEN1;
+
+  weights.alpha = *p++;
+
+  weights.w2 = arma::mat(p, HIDDEN2, HIDDEN1);
+  p += HIDDEN2 * HIDDEN1;
+  weights.b2 = arma::vec(p, HIDDEN2);
+  p += HIDDEN2;
+
+  weights.w3 = arma::rowvec(p, HIDDEN2);
+  p += HIDDEN2;
+  weights.b3 = *p;
+
+  return weights;
+}
+
+void FFNWeights::Forward(const arma::mat &scaledX, arma::rowvec &predictions) const {
+  arma::mat hidden1 = w1 * scaledX;
+  hidden1.each_col() += b1;
+  hidden1 = arma::clamp(hidden1, 0, arma::datum::inf) + alpha;
+
+  arma::mat hidden2 = w2 * hidden1;
+  hidden2.each_col() += b2;
+  hidden2 = 1 / (1 + arma::exp(-hidden2));
+
+  predictions = w3 * hidden2 + b3;
+}
@@ -0,0 +1,33 @@
+#ifndef MLPACK_PROJECT_FFN_WEIGHTS_H
+#define MLPACK_PROJECT_FFN_WEIGHTS_H
+
+#include <mlpack.hpp>
+
+using namespace mlpack;
+
+// The parameters of the network built by ModelGenerator::generateBaseFNN,
+// unpacked into dense matrices:
+//
+//   Linear(32) -> FlexibleReLU -> Linear(16) -> Sigmoid -> Linear(1)
+//
+// mlpack stores every layer's parameters back to back in FFN::Parameters():
+// a Linear layer as its column-major weight matrix followed by its bias, and
+// FlexibleReLU as its single alpha.
+struct FFNWeights {
+  arma::mat w1;   // 32 x inputs
+  arma::vec b1;
+  double alpha;   // FlexibleReLU: f(x) = max(0, x) + alpha
+  arma::mat w2;   // 16 x 32
+  arma::vec b2;
+  arma::rowvec w3;  // 1 x 16
+  double b3;
+
+  // The input dimensionality follows from the parameter count.
+  // Throws std::runtime_error if the count does not fit the architecture above.
+  static FFNWeights Extract(const arma::mat &parameters);
+
+  // Double-precision forward pass on scaled inputs; matches FFN::Predict.
+  void Forward(const arma::mat &scaledX, arma::rowvec &predictions) const;
+};
+
+#endif // MLPACK_PROJECT_FFN_WEIGHTS_H
@@ -0,0 +1,100 @@
+#include "FlatTree.h"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+const uint64_t SIGN = 0x8000000000000000ULL;
+
+// Maps doubles to unsigned integers in the same order, so that bisecting the
+// integers visits every double between two bounds.
+uint64_t orderedKey(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (bits & SIGN) ? ~bits : bits | SIGN;
+}
+
+double fromOrderedKey(uint64_t key) {
+  uint64_t bits = (key & SIGN) ? key & ~SIGN : ~key;
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// The largest x that node sends to its first child.
+double findThreshold(const DecisionTree<> &node, arma::vec &probe, size_t dimension) {
+  const double inf = std::numeric_limits<double>::infinity();
+  probe(dimension) = inf;
+  if (node.CalculateDirection(probe) == 0)
+    return inf;
+  probe(dimension) = -inf;
+  if (node.CalculateDirection(probe) != 0)
+    throw std::runtime_error("Decision tree split sends every value right");
+
+  uint64_t left = orderedKey(-inf);
+  uint64_t right = orderedKey(inf);
+  while (right - left > 1) {
+    const uint64_t mid = left + (right - left) / 2;
+    probe(dimension) = fromOrderedKey(mid);
+    if (node.CalculateDirection(probe) == 0)
+      left = mid;
+    else
+      right = mid;
+  }
+  probe(dimension) = 0;
+  return fromOrderedKey(left);
+}
+
+} // namespace
+
+FlatTree FlatTree::Build(const DecisionTree<> &dt, size_t dimensionality) {
+  FlatTree tree;
+  tree.dimensionality = dimensionality;
+  arma::vec probe(dimensionality, arma::fill::zeros);
+  tree.add(dt, probe, 1);
+  return tree;
+}
+
+void FlatTree::add(const DecisionTree<> &node, arma::vec &probe, size_t level) {
+  depth = std::max(depth, level);
+  const size_t index = nodes.size();
+  nodes.push_back(Node());
+
+  if (node.NumChildren() == 0) {
+    size_t prediction;
+    arma::vec probabilities;
+    node.Classify(probe, prediction, probabilities);
+    if (numClasses == 0)
+      numClasses = probabilities.n_elem;
+    nodes[index].threshold = 0;
+    nodes[index].dimension = leafClass.size();
+    nodes[index].right = 0;
+    leafClass.push_back(prediction);
+    leafProbabilities.insert(leafProbabilities.end(), probabilities.begin(), probabilities.end());
+    return;
+  }
+
+  if (node.NumChildren() != 2)
+    throw std::runtime_error("Only binary decision tree splits can be flattened");
+
+  const size_t dimension = node.SplitDimension();
+  nodes[index].threshold = findThreshold(node, probe, dimension);
+  nodes[index].dimension = dimension;
+  add(node.Child(0), probe, level + 1);
+  nodes[index].right = nodes.size();
+  add(node.Child(1), probe, level + 1);
+}
+
+size_t FlatTree::Classify(const double *x, double *probabilities) const {
+  const size_t leaf = leafOf(x);
+  std::memcpy(probabilities, LeafProbabilities(leaf), numClasses * sizeof(double));
+  return leafClass[leaf];
+}
+
+size_t FlatTree::Classify(const double *x, size_t cls, double &probability) const {
+  const size_t leaf = leafOf(x);
+  probability = cls < numClasses ? LeafProbabilities(leaf)[cls] : 0.0;
+  return leafClass[leaf];
+}
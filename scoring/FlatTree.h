@@ -0,0 +1,68 @@
+#ifndef MLPACK_PROJECT_FLAT_TREE_H
+#define MLPACK_PROJECT_FLAT_TREE_H
+
+#include <cstdint>
+#include <vector>
+#include <mlpack.hpp>
+
+using namespace mlpack;
+
+// A DecisionTree<> flattened into one array of nodes in depth-first order.
+//
+// ModelGenerator::generateBaseDT trains without a DatasetInfo, so every split
+// is a binary numeric split: a point goes left when x[dimension] <= threshold
+// and right otherwise (including NaN). mlpack keeps the split point private,
+// so Build() recovers it exactly by bisecting over the ordered doubles with
+// DecisionTree::CalculateDirection.
+//
+// The flat tree is the interpreted alternative to DecisionTree::Classify and
+// the input to the code generator in GeneratedTree.
+class FlatTree {
+public:
+  struct Node {
+    double threshold;
+    uint32_t dimension;   // Leaf index for leaves
+    uint32_t right;       // Index of the right child; the left one follows the node. 0 for leaves.
+  };
+
+  // Throws std::runtime_error if the tree has a split that is not binary.
+  static FlatTree Build(const DecisionTree<> &dt, size_t dimensionality);
+
+  size_t Classify(const double *x) const {
+    return leafClass[leafOf(x)];
+  }
+
+  // Writes NumClasses() probabilities.
+  size_t Classify(const double *x, double *probabilities) const;
+
+  // Gives only the probability of class `cls`, 0 if there is no such class.
+  size_t Classify(const double *x, size_t cls, double &probability) const;
+
+  size_t Dimensionality() const { return dimensionality; }
+  size_t NumClasses() const { return numClasses; }
+  size_t NumLeaves() const { return leafClass.size(); }
+  size_t Depth() const { return depth; }
+
+  const std::vector<Node> &Nodes() const { return nodes; }
+  size_t LeafClass(size_t leaf) const { return leafClass[leaf]; }
+  const double *LeafProbabilities(size_t leaf) const { return &leafProbabilities[leaf * numClasses]; }
+
+private:
+  size_t dimensionality = 0;
+  size_t numClasses = 0;
+  size_t depth = 0;
+  std::vector<Node> nodes;
+  std::vector<size_t> leafClass;
+  std::vector<double> leafProbabilities;  // NumLeaves() x NumClasses(), row-major
+
+  void add(const DecisionTree<> &node, arma::vec &probe, size_t level);
+
+  size_t leafOf(const double *x) const {
+    size_t i = 0;
+    while (nodes[i].right != 0)
+      i = x[nodes[i].dimension] <= nodes[i].threshold ? i + 1 : nodes[i].right;
+    return nodes[i].dimension;
+  }
+};
+
+#endif // MLPACK_PROJECT_FLAT_TREE_H
@@ -0,0 +1,56 @@
+#include "Float32Models.h"
+
+#include "FFNWeights.h"
+
+Float32Models::Float32Models()
+    : lrIntercept(0), alpha(0), b3(0), scaleMin(0), nnLoaded(false) {}
+
+void Float32Models::SetLinearRegression(LinearRegression const &lr) {
+  const arma::vec &parameters = lr.Parameters();
+  if (lr.Intercept()) {
+    lrIntercept = (float)parameters(0);
+    lrWeights = arma::conv_to<arma::frowvec>::from(parameters.subvec(1, parameters.n_elem - 1).t());
+  } else {
+    lrIntercept = 0;
+    lrWeights = arma::conv_to<arma::frowvec>::from(parameters.t());
+  }
+}
+
+void Float32Models::SetNetwork(FloatFFN const &network, data::MinMaxScaler const &scalar) {
+  // Same parameter layout as the double network.
+  const FFNWeights weights = FFNWeights::Extract(arma::conv_to<arma::mat>::from(network.Parameters()));
+  w1 = arma::conv_to<arma::fmat>::from(weights.w1);
+  b1 = arma::conv_to<arma::fvec>::from(weights.b1);
+  alpha = (float)weights.alpha;
+  w2 = arma::conv_to<arma::fmat>::from(weights.w2);
+  b2 = arma::conv_to<arma::fvec>::from(weights.b2);
+  w3 = arma::conv_to<arma::frowvec>::from(weights.w3);
+  b3 = (float)weights.b3;
+
+  itemMin = arma::conv_to<arma::fvec>::from(scalar.ItemMin());
+  scale = arma::conv_to<arma::fvec>::from(scalar.Scale());
+  scaleMin = (float)scalar.ScaleMin();
+  nnLoaded = true;
+}
+
+void Float32Models::PredictLR(const arma::fmat &data, arma::frowvec &predictions) const {
+  predictions = lrWeights * data + lrIntercept;
+}
+
+void Float32Models::PredictNN(const arma::fmat &data, arma::frowvec &predictions) const {
+  // Same transform as data::MinMaxScaler::Transform.
+  arma::fmat scaled = data.each_col() - itemMin;
+  scaled.each_col() %= scale;
+  scaled += scaleMin;
+
+  // Same layers as FFNWeights::Forward.
+  arma::fmat hidden1 = w1 * scaled;
+  hidden1.each_col() += b1;
+  hidden1 = arma::clamp(hidden1, 0, arma::datum::inf) + alpha;
+
+  arma::fmat hidden2 = w2 * hidden1;
+  hidden2.each_col() += b2;
+  hidden2 = 1 / (1 + arma::exp(-hidden2));
+
+  predictions = w3 * hidden2 + b3;
+}
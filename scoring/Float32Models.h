@@ -0,0 +1,52 @@
+#ifndef MLPACK_PROJECT_FLOAT32_MODELS_H
+#define MLPACK_PROJECT_FLOAT32_MODELS_H
+
+#include <mlpack.hpp>
+#include "../generator/ModelGenerator.h"
+
+using namespace mlpack;
+
+// Single-precision copies of the linear regression and neural network.
+// The linear model is the double model's coefficients cast to float; the
+// network is trained in float by ModelGenerator::generateBaseFNN32. Inputs are
+// min-max scaled in float with the parameters of the shared scaler, so the
+// whole prediction path runs on arma::fmat.
+//
+// The network is kept as its unpacked layers (see FFNWeights) rather than a
+// FloatFFN, whose Predict() writes to the layers' state, so both predict
+// methods are const and can run on several threads at once.
+class Float32Models {
+private:
+  arma::frowvec lrWeights;
+  float lrIntercept;
+
+  arma::fmat w1;
+  arma::fvec b1;
+  float alpha;
+  arma::fmat w2;
+  arma::fvec b2;
+  arma::frowvec w3;
+  float b3;
+
+  arma::fvec itemMin;
+  arma::fvec scale;
+  float scaleMin;
+  bool nnLoaded;
+
+public:
+  Float32Models();
+
+  void SetLinearRegression(LinearRegression const &lr);
+  // Throws std::runtime_error if the network does not have the architecture
+  // of FFNWeights.
+  void SetNetwork(FloatFFN const &network, data::MinMaxScaler const &scalar);
+
+  bool NetworkLoaded() const { return nnLoaded; }
+
+  void PredictLR(const arma::fmat &data, arma::frowvec &predictions) const;
+
+  // Takes unscaled features.
+  void PredictNN(const arma::fmat &data, arma::frowvec &predictions) const;
+};
+
+#endif // MLPACK_PROJECT_FLOAT32_MODELS_H
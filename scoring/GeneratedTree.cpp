@@ -0,0 +1,176 @@
+#include "GeneratedTree.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace {
+
+void indent(std::ostringstream &out, size_t level) {
+  out << std::string(2 * level, ' ');
+}
+
+std::string literal(double value) {
+  if (value == std::numeric_limits<double>::infinity())
+    return "__builtin_inf()";
+  std::ostringstream out;
+  out << std::hexfloat << value;
+  return out.str();
+}
+
+void emitNode(std::ostringstream &out, const FlatTree &tree,
+              std::vector<std::string> const &fieldNames, size_t index, size_t level) {
+  const FlatTree::Node &node = tree.Nodes()[index];
+  if (node.right == 0) {
+    indent(out, level);
+    out << "return leaf(p, " << node.dimension << ");\n";
+    return;
+  }
+  indent(out, level);
+  out << "if (" << fieldNames[node.dimension] << " <= " << literal(node.threshold) << ") {\n";
+  emitNode(out, tree, fieldNames, index + 1, level + 1);
+  indent(out, level);
+  out << "} else {\n";
+  emitNode(out, tree, fieldNames, node.right, level + 1);
+  indent(out, level);
+  out << "}\n";
+}
+
+} // namespace
+
+GeneratedTree::GeneratedTree() : handle(nullptr), classify(nullptr), numClasses(0) {}
+
+GeneratedTree::~GeneratedTree() {
+  unload();
+}
+
+void GeneratedTree::unload() {
+  if (handle)
+    dlclose(handle);
+  handle = nullptr;
+  classify = nullptr;
+}
+
+std::string GeneratedTree::EmitSource(const FlatTree &tree, std::vector<std::string> const &fieldNames, uint64_t checksum) {
+  if (fieldNames.size() != tree.Dimensionality())
+    throw std::runtime_error("Field names do not match the tree dimensionality");
+
+  std::ostringstream out;
+  out << "// Generated by GeneratedTree::EmitSource. Do not edit.\n"
+      << "#include <stddef.h>\n"
+      << "#include <stdint.h>\n\n"
+      << "namespace {\n\n"
+      << "const size_t CLASSES = " << tree.NumClasses() << ";\n\n"
+      << "const size_t LEAF_CLASS[" << tree.NumLeaves() << "] = {";
+  for (size_t leaf = 0; leaf < tree.NumLeaves(); ++leaf)
+    out << (leaf % 16 ? " " : "\n  ") << tree.LeafClass(leaf) << ",";
+  out << "\n};\n\n"
+      << "const double LEAF_PROBABILITIES[" << tree.NumLeaves() << "][CLASSES] = {\n";
+  for (size_t leaf = 0; leaf < tree.NumLeaves(); ++leaf) {
+    out << "  {";
+    for (size_t c = 0; c < tree.NumClasses(); ++c)
+      out << (c ? ", " : "") << literal(tree.LeafProbabilities(leaf)[c]);
+    out << "},\n";
+  }
+  out << "};\n\n"
+      << "inline size_t leaf(double *p, size_t index) {\n"
+      << "  if (p)\n"
+      << "    for (size_t c = 0; c < CLASSES; ++c)\n"
+      << "      p[c] = LEAF_PROBABILITIES[index][c];\n"
+      << "  return LEAF_CLASS[index];\n"
+      << "}\n\n"
+      << "} // namespace\n\n"
+      << "extern \"C\" uint64_t dt_checksum() {\n"
+      << "  return 0x" << std::hex << checksum << std::dec << "ULL;\n"
+      << "}\n\n"
+      << "extern \"C\" size_t dt_classify(const double *x, double *p) {\n";
+  for (size_t i = 0; i < fieldNames.size(); ++i)
+    out << "  const double " << fieldNames[i] << " = x[" << i << "];\n";
+  emitNode(out, tree, fieldNames, 0, 1);
+  out << "}\n";
+  return out.str();
+}
+
+void GeneratedTree::Compile(const std::string &sourcePath, const std::string &libraryPath) {
+  const char *compiler = std::getenv("CXX");
+  // Build next to the target and rename, so a library that is still mapped
+  // by this process is never overwritten in place.
+  const std::string temporary = libraryPath + ".tmp";
+  const std::string command = std::string(compiler && *compiler ? compiler : "c++")
+    + " -std=gnu++11 -O2 -fPIC -shared -o '" + temporary + "' '" + sourcePath + "'";
+  if (std::system(command.c_str()) != 0)
+    throw std::runtime_error("Compiling the decision tree failed: " + command);
+  if (std::rename(temporary.c_str(), libraryPath.c_str()) != 0)
+    throw std::runtime_error("Could not move the compiled decision tree to " + libraryPath);
+}
+
+uint64_t GeneratedTree::FileChecksum(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+    throw std::runtime_error("Cannot read " + path);
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  char buffer[1 << 16];
+  while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+    const std::streamsize n = in.gcount();
+    for (std::streamsize i = 0; i < n; ++i) {
+      hash ^= (unsigned char)buffer[i];
+      hash *= 0x100000001b3ULL;
+    }
+  }
+  return hash;
+}
+
+bool GeneratedTree::Load(const std::string &libraryPath, uint64_t checksum, size_t classes) {
+  unload();
+  struct stat st;
+  if (stat(libraryPath.c_str(), &st) != 0)
+    return false;
+
+  // Without a slash dlopen would search the library path instead.
+  const std::string path = libraryPath.find('/') == std::string::npos ? "./" + libraryPath : libraryPath;
+  // RTLD_LOCAL keeps the generated symbols out of the global namespace.
+  void *library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!library)
+    return false;
+  typedef uint64_t (*ChecksumFn)();
+  ChecksumFn checksumFn = (ChecksumFn)dlsym(library, "dt_checksum");
+  ClassifyFn classifyFn = (ClassifyFn)dlsym(library, "dt_classify");
+  if (!checksumFn || !classifyFn || checksumFn() != checksum) {
+    dlclose(library);
+    return false;
+  }
+  handle = library;
+  classify = classifyFn;
+  numClasses = classes;
+  return true;
+}
+
+void GeneratedTree::Build(const FlatTree &tree, std::vector<std::string> const &fieldNames,
+                          const std::string &modelPath, const std::string &prefix) {
+  const uint64_t checksum = FileChecksum(modelPath);
+  // dlopen returns the already loaded object for a path it has seen, so the
+  // library of every model gets its own name while the previous tree may
+  // still be serving.
+  std::ostringstream name;
+  name << prefix << '_' << std::hex << std::setw(16) << std::setfill('0') << checksum << ".so";
+  const std::string libraryPath = name.str();
+  if (Load(libraryPath, checksum, tree.NumClasses()))
+    return;
+
+  const std::string sourcePath = prefix + ".cpp";
+  std::ofstream source(sourcePath);
+  source << EmitSource(tree, fieldNames, checksum);
+  source.close();
+  if (!source)
+    throw std::runtime_error("Cannot write " + sourcePath);
+
+  Compile(sourcePath, libraryPath);
+  if (!Load(libraryPath, checksum, tree.NumClasses()))
+    throw std::runtime_error("Cannot load the compiled decision tree " + libraryPath);
+}
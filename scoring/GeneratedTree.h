@@ -0,0 +1,67 @@
+#ifndef MLPACK_PROJECT_GENERATED_TREE_H
+#define MLPACK_PROJECT_GENERATED_TREE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "FlatTree.h"
+
+// The decision tree compiled to native code.
+//
+// EmitSource() writes the tree as nested `if` statements over the request's
+// fields, with every threshold as an exact hex float literal. Compile() builds
+// that into a shared object with the system compiler ($CXX, or c++) and
+// Load() dlopens it. The object exports
+//
+//   size_t dt_classify(const double *x, double *probabilities);
+//   uint64_t dt_checksum();
+//
+// where x holds the 19 encoded fields in training order and probabilities may
+// be null. dt_checksum() returns the FNV-1a hash of the model file the code
+// was generated from, so a stale object is never loaded for a retrained tree.
+//
+// The library stays loaded for the lifetime of the object. To replace a
+// tree that other threads are classifying with, build a new object and swap
+// it in (see ModelSet::PublishTree) rather than loading into the old one.
+class GeneratedTree {
+private:
+  typedef size_t (*ClassifyFn)(const double *, double *);
+
+  void *handle;
+  ClassifyFn classify;
+  size_t numClasses;
+
+  void unload();
+
+public:
+  GeneratedTree();
+  ~GeneratedTree();
+  GeneratedTree(const GeneratedTree &) = delete;
+  GeneratedTree &operator=(const GeneratedTree &) = delete;
+
+  static std::string EmitSource(const FlatTree &tree, std::vector<std::string> const &fieldNames, uint64_t checksum);
+
+  // Throws std::runtime_error if the compiler fails.
+  static void Compile(const std::string &sourcePath, const std::string &libraryPath);
+
+  // FNV-1a hash of a file's contents. Throws std::runtime_error if it cannot
+  // be read.
+  static uint64_t FileChecksum(const std::string &path);
+
+  // Loads libraryPath if it exists and was generated from a model with the
+  // given checksum. Returns false otherwise, leaving the tree unloaded.
+  bool Load(const std::string &libraryPath, uint64_t checksum, size_t classes);
+
+  // Loads `<prefix>_<checksum>.so` if it matches modelPath, otherwise
+  // regenerates it from the flat tree via `<prefix>.cpp` and loads the result.
+  void Build(const FlatTree &tree, std::vector<std::string> const &fieldNames,
+             const std::string &modelPath, const std::string &prefix);
+
+  bool Loaded() const { return handle != nullptr; }
+  size_t NumClasses() const { return numClasses; }
+
+  size_t Classify(const double *x) const { return classify(x, nullptr); }
+  size_t Classify(const double *x, double *probabilities) const { return classify(x, probabilities); }
+};
+
+#endif // MLPACK_PROJECT_GENERATED_TREE_H
@@ -0,0 +1,109 @@
+#include "Int8Kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define INT8_KERNELS_X86 1
+#endif
+
+namespace {
+
+typedef void (*MatVecFn)(const uint8_t *, const int8_t *, size_t, size_t, int32_t *);
+
+void matVecScalar(const uint8_t *x, const int8_t *weights, size_t rows, size_t k, int32_t *out) {
+  for (size_t r = 0; r < rows; ++r) {
+    const int8_t *w = weights + r * k;
+    int32_t sum = 0;
+    for (size_t j = 0; j < k; ++j)
+      sum += int32_t(x[j]) * int32_t(w[j]);
+    out[r] = sum;
+  }
+}
+
+#ifdef INT8_KERNELS_X86
+
+__attribute__((target("avx2")))
+int32_t horizontalSum(__m256i v) {
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx2")))
+void matVecAvx2(const uint8_t *x, const int8_t *weights, size_t rows, size_t k, int32_t *out) {
+  const __m256i ones = _mm256_set1_epi16(1);
+  for (size_t r = 0; r < rows; ++r) {
+    const int8_t *w = weights + r * k;
+    __m256i acc = _mm256_setzero_si256();
+    for (size_t j = 0; j < k; j += INT8_KERNEL_WIDTH) {
+      const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + j));
+      const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + j));
+      // u8 x s8 pairs summed to s16, then pairs of s16 summed to s32.
+      acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_maddubs_epi16(a, b), ones));
+    }
+    out[r] = horizontalSum(acc);
+  }
+}
+
+__attribute__((target("avx2,avx512vnni,avx512vl")))
+void matVecAvx512Vnni(const uint8_t *x, const int8_t *weights, size_t rows, size_t k, int32_t *out) {
+  for (size_t r = 0; r < rows; ++r) {
+    const int8_t *w = weights + r * k;
+    __m256i acc = _mm256_setzero_si256();
+    for (size_t j = 0; j < k; j += INT8_KERNEL_WIDTH) {
+      const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + j));
+      const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + j));
+      acc = _mm256_dpbusd_epi32(acc, a, b);
+    }
+    out[r] = horizontalSum(acc);
+  }
+}
+
+__attribute__((target("avx2,avxvnni")))
+void matVecAvxVnni(const uint8_t *x, const int8_t *weights, size_t rows, size_t k, int32_t *out) {
+  for (size_t r = 0; r < rows; ++r) {
+    const int8_t *w = weights + r * k;
+    __m256i acc = _mm256_setzero_si256();
+    for (size_t j = 0; j < k; j += INT8_KERNEL_WIDTH) {
+      const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + j));
+      const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + j));
+      acc = _mm256_dpbusd_avx_epi32(acc, a, b);
+    }
+    out[r] = horizontalSum(acc);
+  }
+}
+
+#endif // INT8_KERNELS_X86
+
+struct Kernel {
+  MatVecFn fn;
+  const char *name;
+};
+
+Kernel selectKernel() {
+#ifdef INT8_KERNELS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512vl"))
+    return Kernel{matVecAvx512Vnni, "avx512-vnni"};
+  if (__builtin_cpu_supports("avxvnni"))
+    return Kernel{matVecAvxVnni, "avx-vnni"};
+  if (__builtin_cpu_supports("avx2"))
+    return Kernel{matVecAvx2, "avx2"};
+#endif
+  return Kernel{matVecScalar, "scalar"};
+}
+
+const Kernel &kernel() {
+  static const Kernel selected = selectKernel();
+  return selected;
+}
+
+} // namespace
+
+void int8MatVec(const uint8_t *x, const int8_t *weights, size_t rows, size_t k, int32_t *out) {
+  kernel().fn(x, weights, rows, k, out);
+}
+
+const char *int8KernelName() {
+  return kernel().name;
+}
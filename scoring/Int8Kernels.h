@@ -0,0 +1,23 @@
+#ifndef MLPACK_PROJECT_INT8_KERNELS_H
+#define MLPACK_PROJECT_INT8_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Number of bytes the int8 kernels consume per step. Rows of weights and
+// activations must be padded with zeros to a multiple of this.
+const size_t INT8_KERNEL_WIDTH = 32;
+
+// out[r] = sum_j x[j] * weights[r * k + j] for r in [0, rows).
+// Activations are unsigned and must be in [0, 127] so that the pairwise sums
+// of maddubs cannot saturate; weights are signed in [-127, 127].
+// k must be a multiple of INT8_KERNEL_WIDTH.
+//
+// The implementation is picked on first use from the CPU: AVX-512 VNNI or
+// AVX-VNNI (vpdpbusd), AVX2 (vpmaddubsw + vpmaddwd), or portable scalar code.
+void int8MatVec(const uint8_t *x, const int8_t *weights, size_t rows, size_t k, int32_t *out);
+
+// Name of the implementation int8MatVec dispatches to.
+const char *int8KernelName();
+
+#endif // MLPACK_PROJECT_INT8_KERNELS_H
@@ -0,0 +1,95 @@
+#include "ModelSet.h"
+
+#include "../util/Json.h"
+#include "../util/Parallel.h"
+
+namespace {
+
+// Rows per parallel block; smaller batches are scored on the calling thread.
+const size_t GRAIN = 256;
+
+} // namespace
+
+ModelSet::ModelSet(data::MinMaxScaler const &scalar, bool useInt8)
+    : scalar(scalar), useInt8(useInt8) {}
+
+void ModelSet::Publish(std::shared_ptr<const ContributionTables> newTables) {
+  std::atomic_store(&tables, std::move(newTables));
+}
+
+void ModelSet::PublishFlatTree(std::shared_ptr<const FlatTree> newTree) {
+  std::atomic_store(&tree, std::move(newTree));
+}
+
+void ModelSet::PublishNetwork(std::shared_ptr<const QuantizedFFN> newNetwork) {
+  std::atomic_store(&quantizedNN, std::move(newNetwork));
+}
+
+void ModelSet::PublishTree(std::shared_ptr<const GeneratedTree> newTree) {
+  std::atomic_store(&generatedDT, std::move(newTree));
+}
+
+ModelSet::Snapshot ModelSet::Current() const {
+  Snapshot snapshot;
+  snapshot.models = this;
+  snapshot.tables = std::atomic_load(&tables);
+  snapshot.tree = std::atomic_load(&tree);
+  snapshot.generatedDT = std::atomic_load(&generatedDT);
+  snapshot.quantizedNN = std::atomic_load(&quantizedNN);
+  return snapshot;
+}
+
+bool ModelSet::Snapshot::Ready() const {
+  return tables && tree && (!models->useInt8 || (quantizedNN && quantizedNN->Ready()));
+}
+
+ModelScores ModelSet::Snapshot::Score(const double *encoded) const {
+  ModelScores scores;
+  scores.lr = LinearScore(encoded);
+  scores.dt = TreeClassify(encoded, scores.dtProbability);
+  scores.nn = NetworkScore(encoded);
+  return scores;
+}
+
+size_t ModelSet::Snapshot::TreeClassify(const double *encoded, double &probability) const {
+  if (generatedDT && generatedDT->NumClasses() == 2) {
+    double probabilities[2];
+    const size_t prediction = generatedDT->Classify(encoded, probabilities);
+    probability = probabilities[1];
+    return prediction;
+  }
+
+  return tree->Classify(encoded, 1, probability);
+}
+
+double ModelSet::Snapshot::NetworkScore(const double *encoded) const {
+  if (!models->useInt8)
+    return tables->ScoreNN(encoded);
+
+  arma::mat scaled;
+  models->scalar.Transform(arma::mat(encoded, tables->Dimensionality(), 1), scaled);
+  arma::rowvec predictions;
+  quantizedNN->Predict(scaled, predictions);
+  return predictions(0);
+}
+
+void ModelSet::Score(const arma::mat &encoded, std::vector<ModelScores> &scores, size_t threads) const {
+  scores.resize(encoded.n_cols);
+  const Snapshot snapshot = Current();
+  parallelFor(encoded.n_cols, GRAIN, [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+      scores[i] = snapshot.Score(encoded.colptr(i));
+  }, threads);
+}
+
+void ModelSet::AppendJson(std::string &out, ModelScores const &scores) {
+  out += "{\"lr\":";
+  appendNumber(out, scores.lr);
+  out += ",\"dt\":";
+  out += std::to_string(scores.dt);
+  out += ",\"dt_probability\":";
+  appendNumber(out, scores.dtProbability);
+  out += ",\"nn\":";
+  appendNumber(out, scores.nn);
+  out += '}';
+}
@@ -0,0 +1,108 @@
+#ifndef MLPACK_PROJECT_MODEL_SET_H
+#define MLPACK_PROJECT_MODEL_SET_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <mlpack.hpp>
+#include "ContributionTables.h"
+#include "FlatTree.h"
+#include "GeneratedTree.h"
+#include "QuantizedFFN.h"
+
+using namespace mlpack;
+
+// Scores of every model for one customer.
+struct ModelScores {
+  double lr;
+  size_t dt;
+  double dtProbability;  // Probability of class 1
+  double nn;
+};
+
+// Scores encoded requests with all models at once, for /predict/all.
+//
+// Every model is evaluated on its thread-safe path: the contribution tables
+// for the linear model and the network (or the int8 network), and the
+// generated tree or the flattened one. So Score() can run on several
+// threads, and a batch is split across cores.
+//
+// /load publishes new contribution tables, a new flattened tree, a new int8
+// network and a new generated tree while requests are being scored. Each is
+// built from the loaded models and never modified, and none refers back to
+// the mlpack models /load overwrites. They are held through shared_ptrs
+// swapped atomically, and every scoring call works on a Snapshot that keeps
+// the ones it started with alive until it returns, so a replaced tree is
+// unloaded only after its last caller. Callers scoring many rows take one
+// Snapshot and reuse it. The scaler, used by the int8 network, is loaded
+// once at startup.
+class ModelSet {
+private:
+  std::shared_ptr<const ContributionTables> tables;
+  std::shared_ptr<const FlatTree> tree;
+  std::shared_ptr<const GeneratedTree> generatedDT;
+  std::shared_ptr<const QuantizedFFN> quantizedNN;
+  data::MinMaxScaler const &scalar;
+  bool useInt8;
+
+public:
+  // The models as published at one point in time.
+  class Snapshot {
+  public:
+    // False until the models have been loaded.
+    bool Ready() const;
+    // Model version of the contribution tables, 0 when not loaded.
+    uint64_t Version() const { return tables ? tables->Version() : 0; }
+
+    ModelScores Score(const double *encoded) const;
+
+    // The individual models, on the same thread-safe paths as Score().
+    double LinearScore(const double *encoded) const { return tables->ScoreLR(encoded); }
+    size_t TreeClassify(const double *encoded, double &probability) const;
+    double NetworkScore(const double *encoded) const;
+
+  private:
+    friend class ModelSet;
+    ModelSet const *models;
+    std::shared_ptr<const ContributionTables> tables;
+    std::shared_ptr<const FlatTree> tree;
+    std::shared_ptr<const GeneratedTree> generatedDT;
+    std::shared_ptr<const QuantizedFFN> quantizedNN;
+  };
+
+  // With useInt8 the network is scored by the published int8 network, which
+  // the set is not ready without.
+  ModelSet(data::MinMaxScaler const &scalar, bool useInt8);
+
+  // Replace the contribution tables, the flattened tree, the int8 network or
+  // the generated tree; requests already scoring keep theirs. A null
+  // generated tree serves the flattened one.
+  void Publish(std::shared_ptr<const ContributionTables> newTables);
+  void PublishFlatTree(std::shared_ptr<const FlatTree> newTree);
+  void PublishNetwork(std::shared_ptr<const QuantizedFFN> newNetwork);
+  void PublishTree(std::shared_ptr<const GeneratedTree> newTree);
+
+  // The int8 network, or null before the first load.
+  std::shared_ptr<const QuantizedFFN> QuantizedNN() const { return std::atomic_load(&quantizedNN); }
+
+  Snapshot Current() const;
+
+  bool Ready() const { return Current().Ready(); }
+
+  // Each takes a Snapshot for the one call.
+  ModelScores Score(const double *encoded) const { return Current().Score(encoded); }
+  double LinearScore(const double *encoded) const { return Current().LinearScore(encoded); }
+  size_t TreeClassify(const double *encoded, double &probability) const {
+    return Current().TreeClassify(encoded, probability);
+  }
+  double NetworkScore(const double *encoded) const { return Current().NetworkScore(encoded); }
+
+  // Scores every column of encoded. With threads other than 1 (0 for every
+  // core) a large batch is split across that many threads.
+  void Score(const arma::mat &encoded, std::vector<ModelScores> &scores, size_t threads = 1) const;
+
+  // {"lr":...,"dt":...,"dt_probability":...,"nn":...}
+  static void AppendJson(std::string &out, ModelScores const &scores);
+};
+
+#endif // MLPACK_PROJECT_MODEL_SET_H
@@ -0,0 +1,153 @@
+#include "QuantizedFFN.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "FFNWeights.h"
+#include "Int8Kernels.h"
+
+namespace {
+
+const int QMAX = 127;
+
+// Largest layer width; sizes the stack buffers used by Predict.
+const size_t MAX_WIDTH = 64;
+
+size_t roundUp(size_t n) {
+  return (n + INT8_KERNEL_WIDTH - 1) / INT8_KERNEL_WIDTH * INT8_KERNEL_WIDTH;
+}
+
+} // namespace
+
+QuantizedFFN::QuantizedFFN() : alpha(0), ready(false) {}
+
+QuantizedFFN::Layer QuantizedFFN::quantizeLayer(
+    const arma::mat &weights,
+    const arma::vec &bias,
+    double inputMin,
+    double inputMax) {
+  Layer layer;
+  layer.inputs = weights.n_cols;
+  layer.outputs = weights.n_rows;
+  layer.stride = roundUp(layer.inputs);
+  if (layer.stride > MAX_WIDTH || layer.outputs > MAX_WIDTH)
+    throw std::runtime_error("Layer too wide for the quantized network");
+
+  layer.weights.assign(layer.outputs * layer.stride, 0);
+  layer.weightScale.resize(layer.outputs);
+  layer.weightSum.assign(layer.outputs, 0);
+  layer.bias = arma::conv_to<std::vector<float>>::from(bias);
+
+  for (size_t r = 0; r < layer.outputs; ++r) {
+    const double maxAbs = arma::abs(weights.row(r)).max();
+    const double scale = maxAbs > 0 ? maxAbs / QMAX : 1.0;
+    layer.weightScale[r] = (float)scale;
+    for (size_t j = 0; j < layer.inputs; ++j) {
+      const int q = (int)std::lround(weights(r, j) / scale);
+      layer.weights[r * layer.stride + j] = (int8_t)std::max(-QMAX, std::min(QMAX, q));
+      layer.weightSum[r] += layer.weights[r * layer.stride + j];
+    }
+  }
+
+  layer.inputMin = (float)inputMin;
+  layer.inputScale = inputMax > inputMin ? (float)((inputMax - inputMin) / QMAX) : 1.0f;
+  return layer;
+}
+
+void QuantizedFFN::runLayer(const Layer &layer, const float *input, float *output) {
+  alignas(32) uint8_t q[MAX_WIDTH] = {0};
+  alignas(32) int32_t acc[MAX_WIDTH];
+
+  const float inverseScale = 1.0f / layer.inputScale;
+  for (size_t j = 0; j < layer.inputs; ++j) {
+    const float v = std::nearbyint((input[j] - layer.inputMin) * inverseScale);
+    q[j] = (uint8_t)std::max(0.0f, std::min((float)QMAX, v));
+  }
+
+  int8MatVec(q, layer.weights.data(), layer.outputs, layer.stride, acc);
+
+  // sum_j w_j * a_j with w_j = ws * wq_j and a_j = min + s * q_j.
+  for (size_t r = 0; r < layer.outputs; ++r) {
+    output[r] = layer.weightScale[r]
+        * (layer.inputScale * (float)acc[r] + layer.inputMin * (float)layer.weightSum[r])
+        + layer.bias[r];
+  }
+}
+
+void QuantizedFFN::Quantize(
+    FFN<MeanSquaredError, RandomInitialization> &nn,
+    const arma::mat &calibrationX) {
+  FFNWeights weights = FFNWeights::Extract(nn.Parameters());
+
+  double inMin = 0, inMax = 1;
+  double hiddenMin, hiddenMax;
+  double sigmoidMin = 0, sigmoidMax = 1;
+
+  if (calibrationX.n_cols > 0) {
+    // Guard against a layout change in mlpack: the unpacked weights must
+    // reproduce the network's own predictions.
+    arma::rowvec expected, actual;
+    nn.Predict(calibrationX, expected);
+    weights.Forward(calibrationX, actual);
+    if (arma::abs(expected - actual).max() > 1e-6)
+      throw std::runtime_error("Network parameters do not match the expected layout");
+
+    inMin = calibrationX.min();
+    inMax = calibrationX.max();
+
+    arma::mat hidden1 = weights.w1 * calibrationX;
+    hidden1.each_col() += weights.b1;
+    hidden1 = arma::clamp(hidden1, 0, arma::datum::inf) + weights.alpha;
+    hiddenMin = hidden1.min();
+    hiddenMax = hidden1.max();
+
+    arma::mat hidden2 = weights.w2 * hidden1;
+    hidden2.each_col() += weights.b2;
+    hidden2 = 1 / (1 + arma::exp(-hidden2));
+    sigmoidMin = hidden2.min();
+    sigmoidMax = hidden2.max();
+  } else {
+    // Interval bounds of the first layer for inputs in [0, 1].
+    const arma::vec upper = weights.b1 + arma::sum(arma::clamp(weights.w1, 0, arma::datum::inf), 1);
+    hiddenMin = weights.alpha;
+    hiddenMax = std::max(0.0, upper.max()) + weights.alpha;
+  }
+
+  layers[0] = quantizeLayer(weights.w1, weights.b1, inMin, inMax);
+  layers[1] = quantizeLayer(weights.w2, weights.b2, hiddenMin, hiddenMax);
+  layers[2] = quantizeLayer(arma::mat(weights.w3), arma::vec{weights.b3}, sigmoidMin, sigmoidMax);
+  alpha = (float)weights.alpha;
+  ready = true;
+}
+
+void QuantizedFFN::Predict(const arma::mat &scaledX, arma::rowvec &predictions) const {
+  if (!ready)
+    throw std::runtime_error("Network has not been quantized");
+
+  predictions.set_size(scaledX.n_cols);
+  float input[MAX_WIDTH];
+  float hidden1[MAX_WIDTH];
+  float hidden2[MAX_WIDTH];
+  float output[1];
+
+  for (size_t c = 0; c < scaledX.n_cols; ++c) {
+    const double *x = scaledX.colptr(c);
+    for (size_t j = 0; j < layers[0].inputs; ++j)
+      input[j] = (float)x[j];
+
+    runLayer(layers[0], input, hidden1);
+    for (size_t j = 0; j < layers[0].outputs; ++j)
+      hidden1[j] = std::max(0.0f, hidden1[j]) + alpha;
+
+    runLayer(layers[1], hidden1, hidden2);
+    for (size_t j = 0; j < layers[1].outputs; ++j)
+      hidden2[j] = 1.0f / (1.0f + std::exp(-hidden2[j]));
+
+    runLayer(layers[2], hidden2, output);
+    predictions(c) = output[0];
+  }
+}
+
+const char *QuantizedFFN::KernelName() {
+  return int8KernelName();
+}
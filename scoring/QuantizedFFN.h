@@ -0,0 +1,61 @@
+#ifndef MLPACK_PROJECT_QUANTIZED_FFN_H
+#define MLPACK_PROJECT_QUANTIZED_FFN_H
+
+#include <cstdint>
+#include <vector>
+#include <mlpack.hpp>
+
+using namespace mlpack;
+
+// Int8 post-training quantization of the network from
+// ModelGenerator::generateBaseFNN.
+//
+// Each Linear layer stores int8 weights with one scale per output channel.
+// Its input is quantized to [0, 127] with a per-layer offset and scale taken
+// from the activation ranges seen on a calibration set. The dot products run
+// in int32 through int8MatVec. Biases, FlexibleReLU and Sigmoid stay in float.
+//
+// Predict() keeps no state in the object, so unlike FFN::Predict it is safe to
+// call from several threads at once. Quantize() is not: a served network is
+// never quantized again, and /load quantizes a new one and swaps it in (see
+// ModelSet::PublishNetwork).
+class QuantizedFFN {
+private:
+  struct Layer {
+    size_t inputs;
+    size_t outputs;
+    size_t stride;                   // inputs rounded up to the kernel width
+    std::vector<int8_t> weights;     // outputs x stride, row-major
+    std::vector<float> weightScale;  // per output channel
+    std::vector<int32_t> weightSum;  // per output channel, of the int8 weights
+    std::vector<float> bias;
+    float inputMin;                  // input ~= inputMin + inputScale * q
+    float inputScale;
+  };
+
+  Layer layers[3];
+  float alpha;
+  bool ready;
+
+  static Layer quantizeLayer(const arma::mat &weights, const arma::vec &bias, double inputMin, double inputMax);
+  static void runLayer(const Layer &layer, const float *input, float *output);
+
+public:
+  QuantizedFFN();
+
+  // Quantizes the trained network. calibrationX holds scaled inputs, e.g.
+  // the scaled training data; if it is empty, activation ranges are bounded
+  // from the weights instead, assuming inputs in [0, 1].
+  // Throws std::runtime_error if the network does not have the expected
+  // architecture.
+  void Quantize(FFN<MeanSquaredError, RandomInitialization> &nn, const arma::mat &calibrationX);
+
+  bool Ready() const { return ready; }
+
+  // Takes scaled inputs, like FFN::Predict.
+  void Predict(const arma::mat &scaledX, arma::rowvec &predictions) const;
+
+  static const char *KernelName();
+};
+
+#endif // MLPACK_PROJECT_QUANTIZED_FFN_H
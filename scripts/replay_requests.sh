@@ -0,0 +1,70 @@
+#!/usr/bin/env bash
+# Starts the server, replays a request corpus through the predict, stats and
+# generate routes, then shuts the server down cleanly so that instrumented
+# builds write their profile data.
+#
+# Usage: scripts/replay_requests.sh <server-binary> [corpus.jsonl]
+#
+# The corpus holds one predict body (a JSON object) per line. Without one, every
+# row of data/cleaned_credit_data.csv is converted into a request body.
+set -euo pipefail
+
+SERVER=${1:?usage: $0 <server-binary> [corpus.jsonl]}
+CORPUS=${2:-}
+HOST=http://localhost:3000
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+if [ -z "$CORPUS" ]; then
+  CORPUS=$WORK/corpus.jsonl
+  awk -F, '
+    BEGIN {
+      split("gender SeniorCitizen Partner Dependents tenure PhoneService MultipleLines InternetService OnlineSecurity OnlineBackup DeviceProtection TechSupport StreamingTV StreamingMovies Contract PaperlessBilling PaymentMethod MonthlyCharges TotalCharges", names, " ")
+      numeric[2] = numeric[5] = numeric[18] = numeric[19] = 1
+    }
+    {
+      body = "{"
+      for (i = 1; i <= 19; ++i) {
+        value = numeric[i] ? $i : "\"" $i "\""
+        body = body (i > 1 ? ", " : "") "\"" names[i] "\": " value
+      }
+      print body "}"
+    }' data/cleaned_credit_data.csv > "$CORPUS"
+fi
+
+# One curl process per route keeps the connection alive across the corpus.
+write_config() {
+  local route=$1
+  while IFS= read -r body; do
+    [ -z "$body" ] && continue
+    printf 'url = "%s%s"\n' "$HOST" "$route"
+    printf 'data = "%s"\n' "$(printf '%s' "$body" | sed 's/\\/\\\\/g; s/"/\\"/g')"
+    printf 'header = "Content-Type: application/json"\n'
+    printf 'output = "/dev/null"\n'
+    printf 'next\n'
+  done < "$CORPUS"
+}
+
+mkdir -p models
+"$SERVER" &
+PID=$!
+
+for _ in $(seq 1 120); do
+  curl -s -o /dev/null "$HOST/" && break
+  sleep 1
+done
+
+curl -s -o /dev/null "$HOST/generate"
+curl -s -o /dev/null "$HOST/load"
+
+for model in lr dt nn; do
+  write_config "/$model/predict" > "$WORK/$model.curl"
+  curl -s -K "$WORK/$model.curl"
+  curl -s -o /dev/null "$HOST/$model/stats"
+done
+
+curl -s -o /dev/null "$HOST/metrics"
+
+kill -INT "$PID"
+wait "$PID" || true
+echo "Replayed $(wc -l < "$CORPUS") requests per model"
@@ -0,0 +1,11 @@
+#include "Compression.h"
+
+void CompressionThreshold::before_handle(crow::request &, crow::response &, context &) {}
+
+void CompressionThreshold::after_handle(crow::request &, crow::response &res, context &) {
+#ifdef CROW_ENABLE_COMPRESSION
+  res.compressed = res.body.size() >= minBytes;
+#else
+  (void)res;
+#endif
+}
@@ -0,0 +1,21 @@
+#ifndef MLPACK_PROJECT_COMPRESSION_H
+#define MLPACK_PROJECT_COMPRESSION_H
+
+#include <cstddef>
+#include "../crow_all.h"
+
+// Crow middleware deciding which responses are gzipped when the server is
+// compiled with CROW_ENABLE_COMPRESSION. Crow compresses every response by
+// default; this runs after each handler and leaves bodies smaller than
+// minBytes as they are: compressing a one-line prediction costs more than it
+// saves on the wire.
+struct CompressionThreshold {
+  struct context {};
+
+  size_t minBytes = 1024;
+
+  void before_handle(crow::request &req, crow::response &res, context &ctx);
+  void after_handle(crow::request &req, crow::response &res, context &ctx);
+};
+
+#endif // MLPACK_PROJECT_COMPRESSION_H
@@ -0,0 +1,90 @@
+#include "ConcurrencyLimiter.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+ConcurrencyLimiter::Permit::Permit(ConcurrencyLimiter *limiter)
+    : limiter(limiter), start(Clock::now()) {}
+
+ConcurrencyLimiter::Permit::Permit(Permit &&other)
+    : limiter(other.limiter), start(other.start) {
+  other.limiter = nullptr;
+}
+
+ConcurrencyLimiter::Permit::~Permit() {
+  if (limiter)
+    limiter->release(std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - start));
+}
+
+ConcurrencyLimiter::ConcurrencyLimiter(
+    std::string const &name,
+    size_t initialLimit,
+    size_t minLimit,
+    size_t maxLimit,
+    std::chrono::milliseconds targetLatency)
+    : name(name),
+      limit(initialLimit),
+      minLimit(minLimit),
+      maxLimit(maxLimit),
+      inFlight(0),
+      targetLatency(targetLatency),
+      smoothedLatencyUs(0),
+      admitted(0),
+      rejected(0) {}
+
+ConcurrencyLimiter::Permit ConcurrencyLimiter::tryAcquire() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (inFlight < static_cast<size_t>(limit)) {
+      ++inFlight;
+      ++admitted;
+      return Permit(this);
+    }
+  }
+  ++rejected;
+  return Permit(nullptr);
+}
+
+void ConcurrencyLimiter::release(std::chrono::microseconds latency) {
+  std::lock_guard<std::mutex> lock(mtx);
+  --inFlight;
+
+  // Exponentially weighted latency so a single slow request does not
+  // collapse the limit.
+  const double sample = static_cast<double>(latency.count());
+  smoothedLatencyUs = (smoothedLatencyUs == 0)
+      ? sample
+      : 0.9 * smoothedLatencyUs + 0.1 * sample;
+
+  if (smoothedLatencyUs > targetLatency.count())
+    limit = std::max(minLimit, limit * 0.9);  // Multiplicative decrease.
+  else
+    limit = std::min(maxLimit, limit + 1.0 / limit);  // Additive increase.
+}
+
+std::string ConcurrencyLimiter::ReportHeader() {
+  std::ostringstream out;
+  out << std::left << std::setw(14) << "route"
+    << std::right << std::setw(8) << "limit"
+    << std::setw(10) << "inflight"
+    << std::setw(12) << "admitted"
+    << std::setw(12) << "rejected"
+    << std::setw(14) << "latency(us)"
+    << '\n';
+  return out.str();
+}
+
+std::string ConcurrencyLimiter::Report() {
+  std::lock_guard<std::mutex> lock(mtx);
+  std::ostringstream out;
+  out << std::left << std::setw(14) << name
+    << std::right << std::setw(8) << std::fixed << std::setprecision(1) << limit
+    << std::setw(10) << inFlight
+    << std::setw(12) << admitted.load()
+    << std::setw(12) << rejected.load()
+    << std::setw(14) << std::setprecision(0) << smoothedLatencyUs
+    << '\n';
+  return out.str();
+}
@@ -0,0 +1,62 @@
+#ifndef MLPACK_PROJECT_CONCURRENCY_LIMITER_H
+#define MLPACK_PROJECT_CONCURRENCY_LIMITER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Bounds the number of requests a route may work on at once.
+// The limit adapts with AIMD on observed latency: it grows by roughly one slot
+// per window while requests finish under the target latency and shrinks
+// multiplicatively when they do not. Requests over the limit are rejected
+// immediately so the caller can answer 503 instead of queueing.
+class ConcurrencyLimiter {
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  std::string name;
+  std::mutex mtx;
+  double limit;
+  double minLimit;
+  double maxLimit;
+  size_t inFlight;
+  std::chrono::microseconds targetLatency;
+  double smoothedLatencyUs;
+
+  std::atomic<uint64_t> admitted;
+  std::atomic<uint64_t> rejected;
+
+  void release(std::chrono::microseconds latency);
+
+public:
+  // RAII handle for an admitted request. Evaluates to false when rejected.
+  class Permit {
+  private:
+    ConcurrencyLimiter *limiter;
+    Clock::time_point start;
+  public:
+    explicit Permit(ConcurrencyLimiter *limiter);
+    Permit(Permit &&other);
+    Permit(const Permit &) = delete;
+    Permit &operator=(const Permit &) = delete;
+    ~Permit();
+
+    explicit operator bool() const { return limiter != nullptr; }
+  };
+
+  ConcurrencyLimiter(
+      std::string const &name,
+      size_t initialLimit,
+      size_t minLimit,
+      size_t maxLimit,
+      std::chrono::milliseconds targetLatency);
+
+  Permit tryAcquire();
+
+  static std::string ReportHeader();
+  std::string Report();
+};
+
+#endif // MLPACK_PROJECT_CONCURRENCY_LIMITER_H
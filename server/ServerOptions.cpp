@@ -0,0 +1,98 @@
+#include "ServerOptions.h"
+
+#include <stdexcept>
+
+namespace {
+
+size_t parseCount(std::string const &option, const char *value) {
+  try {
+    size_t pos = 0;
+    long long parsed = std::stoll(value, &pos);
+    if (pos == std::string(value).size() && parsed >= 0)
+      return static_cast<size_t>(parsed);
+  } catch (const std::logic_error &) {
+  }
+  throw std::invalid_argument("Invalid value for " + option + ": " + value);
+}
+
+double parseNumber(std::string const &option, const char *value) {
+  try {
+    size_t pos = 0;
+    double parsed = std::stod(value, &pos);
+    if (pos == std::string(value).size())
+      return parsed;
+  } catch (const std::logic_error &) {
+  }
+  throw std::invalid_argument("Invalid value for " + option + ": " + value);
+}
+
+} // namespace
+
+ServerOptions ServerOptions::Parse(int argc, char **argv) {
+  ServerOptions options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--cache-entries") {
+      if (i + 1 >= argc)
+        throw std::invalid_argument("Missing value for " + arg);
+      options.cacheEntries = parseCount(arg, argv[++i]);
+    } else if (arg == "--serve-only") {
+      options.servingOnly = true;
+    } else if (arg == "--f32") {
+      options.float32 = true;
+    } else if (arg == "--nn-int8") {
+      options.nnInt8 = true;
+    } else if (arg == "--dt-codegen") {
+      options.dtCodegen = true;
+    } else if (arg == "--compress-min-bytes") {
+      if (i + 1 >= argc)
+        throw std::invalid_argument("Missing value for " + arg);
+      options.compressMinBytes = parseCount(arg, argv[++i]);
+    } else if (arg == "--unknown-category") {
+      if (i + 1 >= argc)
+        throw std::invalid_argument("Missing value for " + arg);
+      options.unknownCategory = CategoricalEncoder::ParsePolicy(argv[++i]);
+    } else if (arg == "--unknown-sentinel") {
+      if (i + 1 >= argc)
+        throw std::invalid_argument("Missing value for " + arg);
+      options.unknownSentinel = parseNumber(arg, argv[++i]);
+    } else if (arg == "--cascade-model") {
+      if (i + 1 >= argc)
+        throw std::invalid_argument("Missing value for " + arg);
+      options.cascadeModel = Cascade::ParseCheapModel(argv[++i]);
+    } else if (arg == "--cascade-band") {
+      if (i + 1 >= argc)
+        throw std::invalid_argument("Missing value for " + arg);
+      std::string band = argv[++i];
+      size_t colon = band.find(':');
+      if (colon == std::string::npos)
+        throw std::invalid_argument("Invalid value for " + arg + ": " + band);
+      options.cascadeLow = parseNumber(arg, band.substr(0, colon).c_str());
+      options.cascadeHigh = parseNumber(arg, band.substr(colon + 1).c_str());
+    } else if (arg == "--keepalive-timeout") {
+      if (i + 1 >= argc)
+        throw std::invalid_argument("Missing value for " + arg);
+      options.keepAliveTimeout = parseCount(arg, argv[++i]);
+      if (options.keepAliveTimeout == 0 || options.keepAliveTimeout > 255)
+        throw std::invalid_argument("--keepalive-timeout must be between 1 and 255");
+    } else {
+      throw std::invalid_argument("Unknown option: " + arg);
+    }
+  }
+  return options;
+}
+
+std::string ServerOptions::Usage() {
+  return "Usage: ml-app.o [options]\n"
+         "  --serve-only        Start from saved models without loading the training CSV\n"
+         "  --f32               Also serve single-precision models under /f32\n"
+         "  --nn-int8           Serve /nn/predict from the int8 quantized network\n"
+         "  --dt-codegen        Serve /dt/predict from the decision tree compiled to native code\n"
+         "  --cascade-model M   Cheap model of /cascade/predict: lr or dt (default lr)\n"
+         "  --cascade-band L:H  Escalate cheap scores in [L, H] to the network (default 0.35:0.65)\n"
+         "  --cache-entries N   Cache up to N prediction responses (default 0, disabled)\n"
+         "  --unknown-category P  Unseen categories: reject (400), sentinel or count (default reject)\n"
+         "  --unknown-sentinel X  Value used by --unknown-category sentinel (default -1)\n"
+         "  --compress-min-bytes N  Only compress responses of at least N bytes (default 1024)\n"
+         "  --keepalive-timeout S   Close idle keep-alive connections after S seconds (default 5)\n";
+}
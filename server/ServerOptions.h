@@ -0,0 +1,48 @@
+#ifndef MLPACK_PROJECT_SERVER_OPTIONS_H
+#define MLPACK_PROJECT_SERVER_OPTIONS_H
+
+#include <string>
+#include "../encoder/CategoricalEncoder.h"
+#include "../scoring/Cascade.h"
+
+// Command line options for ml-app.
+struct ServerOptions {
+  // Maximum number of cached prediction responses. 0 disables the cache.
+  size_t cacheEntries = 0;
+
+  // Responses smaller than this are never compressed.
+  size_t compressMinBytes = 1024;
+
+  // Start from the saved models and data/dataset_info.bin without reading the
+  // training CSV. The stats routes load it on first use.
+  bool servingOnly = false;
+
+  // Also train or load single-precision models, served under /f32.
+  bool float32 = false;
+
+  // Serve /nn/predict from the int8 quantized network.
+  bool nnInt8 = false;
+
+  // Serve /dt/predict from the decision tree compiled to a shared object.
+  bool dtCodegen = false;
+
+  // /cascade/predict: the cheap model and the band of its scores that are
+  // escalated to the network. /cascade/tune replaces the band.
+  Cascade::CheapModel cascadeModel = Cascade::CheapModel::LR;
+  double cascadeLow = 0.35;
+  double cascadeHigh = 0.65;
+
+  // How request values missing from the training dictionaries are encoded.
+  UnknownCategoryPolicy unknownCategory = UnknownCategoryPolicy::Reject;
+  double unknownSentinel = -1;
+
+  // Seconds an idle keep-alive connection is held open.
+  size_t keepAliveTimeout = 5;
+
+  // Throws std::invalid_argument on unknown or malformed options.
+  static ServerOptions Parse(int argc, char **argv);
+
+  static std::string Usage();
+};
+
+#endif // MLPACK_PROJECT_SERVER_OPTIONS_H
@@ -0,0 +1,262 @@
+#include "StressEngine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include "../util/Parallel.h"
+
+namespace {
+
+// Per-thread totals of one scenario.
+struct Accumulator {
+  double sum = 0;
+  double shift = 0;
+  double absShift = 0;
+  size_t above = 0;
+  size_t crossedUp = 0;
+  size_t crossedDown = 0;
+  std::vector<uint32_t> histogram;
+};
+
+size_t pdBin(double pd) {
+  return std::min(StressEngine::PD_BINS - 1, (size_t)(pd * StressEngine::PD_BINS));
+}
+
+// Quantile read from a histogram of `rows` PDs on [0, 1], interpolated
+// within the bin that reaches it.
+double histogramQuantile(std::vector<uint64_t> const &histogram, size_t rows, double q) {
+  if (rows == 0)
+    return 0;
+  const double target = q * rows;
+  double below = 0;
+  for (size_t k = 0; k < histogram.size(); ++k) {
+    if (histogram[k] > 0 && below + histogram[k] >= target) {
+      const double frac = (target - below) / histogram[k];
+      return (k + frac) / histogram.size();
+    }
+    below += histogram[k];
+  }
+  return 1;
+}
+
+std::string jsonString(crow::json::rvalue const &value, std::string const &what) {
+  if (value.t() != crow::json::type::String)
+    throw std::invalid_argument(what + " must be a string");
+  return value.s();
+}
+
+} // namespace
+
+const size_t StressEngine::MAX_SCENARIOS;
+const size_t StressEngine::BLOCK_ROWS;
+const size_t StressEngine::PD_BINS;
+
+StressEngine::StressEngine(CategoricalEncoder const &encoder,
+                           std::vector<std::string> const &fieldNames,
+                           ModelSet const &models,
+                           PortfolioReader::PdModel model,
+                           size_t threads)
+    : encoder(encoder), fieldNames(fieldNames), models(models), model(model), threads(threads) {}
+
+std::vector<Scenario> StressEngine::ParseScenarios(crow::json::rvalue const &body) const {
+  if (body.t() != crow::json::type::List)
+    throw std::invalid_argument("Expected an array of scenarios");
+  if (body.size() == 0 || body.size() > MAX_SCENARIOS)
+    throw std::invalid_argument("Between 1 and " + std::to_string(MAX_SCENARIOS) + " scenarios are allowed");
+
+  std::vector<Scenario> scenarios;
+  for (size_t i = 0; i < body.size(); ++i) {
+    crow::json::rvalue const &item = body[i];
+    if (item.t() != crow::json::type::Object || !item.has("shocks"))
+      throw std::invalid_argument("Each scenario needs a list of shocks");
+    Scenario scenario;
+    scenario.name = item.has("name") ? jsonString(item["name"], "name") : "scenario " + std::to_string(i + 1);
+
+    crow::json::rvalue const &shocks = item["shocks"];
+    if (shocks.t() != crow::json::type::List)
+      throw std::invalid_argument("shocks must be an array");
+    for (size_t j = 0; j < shocks.size(); ++j) {
+      crow::json::rvalue const &entry = shocks[j];
+      if (entry.t() != crow::json::type::Object || !entry.has("field"))
+        throw std::invalid_argument("Each shock needs a field");
+      const std::string field = jsonString(entry["field"], "field");
+      auto it = std::find(fieldNames.begin(), fieldNames.end(), field);
+      if (it == fieldNames.end())
+        throw std::invalid_argument("Unknown field: " + field);
+
+      Shock shock;
+      shock.dimension = it - fieldNames.begin();
+      const bool categorical = encoder.IsCategorical(shock.dimension);
+      if (entry.has("set")) {
+        shock.kind = Shock::Kind::Set;
+        crow::json::rvalue const &value = entry["set"];
+        if (categorical) {
+          const std::string name = jsonString(value, "set");
+          size_t code = 0;
+          while (code < encoder.NumCategories(shock.dimension) &&
+                 encoder.CategoryName(shock.dimension, code) != name)
+            ++code;
+          if (code == encoder.NumCategories(shock.dimension))
+            throw std::invalid_argument("Unknown category of " + field + ": " + name);
+          shock.value = (double)code;
+        } else {
+          if (value.t() != crow::json::type::Number)
+            throw std::invalid_argument("set of " + field + " must be a number");
+          shock.value = value.d();
+        }
+      } else if (entry.has("scale") || entry.has("add")) {
+        if (categorical)
+          throw std::invalid_argument(field + " is categorical and can only be set");
+        shock.kind = entry.has("scale") ? Shock::Kind::Scale : Shock::Kind::Add;
+        crow::json::rvalue const &value = entry[entry.has("scale") ? "scale" : "add"];
+        if (value.t() != crow::json::type::Number)
+          throw std::invalid_argument("Shock of " + field + " must be a number");
+        shock.value = value.d();
+      } else {
+        throw std::invalid_argument("Shock of " + field + " needs scale, add or set");
+      }
+      scenario.shocks.push_back(shock);
+    }
+    scenarios.push_back(scenario);
+  }
+  return scenarios;
+}
+
+double StressEngine::score(ModelSet::Snapshot const &snapshot, const double *encoded) const {
+  double pd;
+  if (model == PortfolioReader::PdModel::LR)
+    pd = snapshot.LinearScore(encoded);
+  else if (model == PortfolioReader::PdModel::DT)
+    snapshot.TreeClassify(encoded, pd);
+  else
+    pd = snapshot.NetworkScore(encoded);
+  // The regression outputs are not bounded to [0, 1].
+  return std::min(1.0, std::max(0.0, pd));
+}
+
+std::vector<ScenarioResult> StressEngine::Run(const arma::mat &data,
+                                              std::vector<Scenario> const &scenarios,
+                                              double cutoff) const {
+  const size_t rows = data.n_cols;
+  const size_t dims = data.n_rows;
+  if (dims != encoder.Dimensionality())
+    throw std::invalid_argument("data does not have one row per field");
+  const size_t workers = threads == 0 ? defaultThreadCount() : threads;
+  const ModelSet::Snapshot snapshot = models.Current();
+
+  // The baseline PD of every row, which the scenarios are compared with.
+  std::vector<double> baseline(rows);
+  parallelFor(rows, BLOCK_ROWS, [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+      baseline[i] = score(snapshot, data.colptr(i));
+  }, workers);
+
+  // Slot 0 is the baseline, so it is reported with the same statistics.
+  const size_t slots = scenarios.size() + 1;
+  std::vector<std::vector<Accumulator>> local(workers, std::vector<Accumulator>(slots));
+  for (auto &accumulators : local) {
+    for (Accumulator &acc : accumulators)
+      acc.histogram.assign(PD_BINS, 0);
+  }
+  for (size_t i = 0; i < rows; ++i) {
+    Accumulator &acc = local[0][0];
+    acc.sum += baseline[i];
+    acc.above += baseline[i] >= cutoff;
+    ++acc.histogram[pdBin(baseline[i])];
+  }
+
+  // One item per (scenario, block); the shocked block lives only in the
+  // worker's scratch copy.
+  const size_t blocks = (rows + BLOCK_ROWS - 1) / BLOCK_ROWS;
+  std::vector<std::vector<double>> scratch(workers, std::vector<double>(dims * BLOCK_ROWS));
+  parallelFor(scenarios.size() * blocks, 1, [&](size_t worker, size_t begin, size_t end) {
+    for (size_t item = begin; item < end; ++item) {
+      const size_t s = item / blocks;
+      const size_t first = (item % blocks) * BLOCK_ROWS;
+      const size_t count = std::min(BLOCK_ROWS, rows - first);
+      double *block = scratch[worker].data();
+      std::memcpy(block, data.colptr(first), sizeof(double) * dims * count);
+
+      for (Shock const &shock : scenarios[s].shocks) {
+        double *x = block + shock.dimension;
+        for (size_t j = 0; j < count; ++j, x += dims) {
+          if (shock.kind == Shock::Kind::Scale)
+            *x *= shock.value;
+          else if (shock.kind == Shock::Kind::Add)
+            *x += shock.value;
+          else
+            *x = shock.value;
+        }
+      }
+
+      Accumulator &acc = local[worker][s + 1];
+      for (size_t j = 0; j < count; ++j) {
+        const double pd = score(snapshot, block + j * dims);
+        const double base = baseline[first + j];
+        acc.sum += pd;
+        acc.shift += pd - base;
+        acc.absShift += std::fabs(pd - base);
+        acc.above += pd >= cutoff;
+        acc.crossedUp += base < cutoff && pd >= cutoff;
+        acc.crossedDown += base >= cutoff && pd < cutoff;
+        ++acc.histogram[pdBin(pd)];
+      }
+    }
+  }, workers);
+
+  std::vector<ScenarioResult> results;
+  for (size_t s = 0; s < slots; ++s) {
+    Accumulator total;
+    std::vector<uint64_t> histogram(PD_BINS, 0);
+    for (auto const &accumulators : local) {
+      Accumulator const &acc = accumulators[s];
+      total.sum += acc.sum;
+      total.shift += acc.shift;
+      total.absShift += acc.absShift;
+      total.above += acc.above;
+      total.crossedUp += acc.crossedUp;
+      total.crossedDown += acc.crossedDown;
+      for (size_t k = 0; k < PD_BINS; ++k)
+        histogram[k] += acc.histogram[k];
+    }
+
+    ScenarioResult result;
+    result.name = s == 0 ? "baseline" : scenarios[s - 1].name;
+    result.rows = rows;
+    const double n = rows ? (double)rows : 1.0;
+    result.meanPd = total.sum / n;
+    result.meanShift = total.shift / n;
+    result.meanAbsShift = total.absShift / n;
+    result.p50 = histogramQuantile(histogram, rows, 0.5);
+    result.p90 = histogramQuantile(histogram, rows, 0.9);
+    result.p99 = histogramQuantile(histogram, rows, 0.99);
+    result.aboveCutoff = total.above / n;
+    result.crossedUp = total.crossedUp;
+    result.crossedDown = total.crossedDown;
+    results.push_back(result);
+  }
+  return results;
+}
+
+std::string StressEngine::Report(std::vector<ScenarioResult> const &results, double cutoff) {
+  std::ostringstream out;
+  out << "rows: " << (results.empty() ? 0 : results[0].rows) << ", cutoff: " << cutoff << '\n' << '\n'
+    << std::left << std::setw(24) << "scenario" << std::right
+    << std::setw(10) << "mean PD" << std::setw(10) << "shift" << std::setw(10) << "|shift|"
+    << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+    << std::setw(10) << ">= cut" << std::setw(10) << "up" << std::setw(10) << "down"
+    << '\n' << '\n';
+  for (ScenarioResult const &result : results) {
+    out << std::left << std::setw(24) << result.name.substr(0, 23) << std::right
+      << std::fixed << std::setprecision(4)
+      << std::setw(10) << result.meanPd << std::setw(10) << result.meanShift
+      << std::setw(10) << result.meanAbsShift << std::setw(10) << result.p50
+      << std::setw(10) << result.p90 << std::setw(10) << result.p99
+      << std::setw(10) << result.aboveCutoff
+      << std::setw(10) << result.crossedUp << std::setw(10) << result.crossedDown << '\n';
+  }
+  return out.str();
+}
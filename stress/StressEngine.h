@@ -0,0 +1,88 @@
+#ifndef MLPACK_PROJECT_STRESS_ENGINE_H
+#define MLPACK_PROJECT_STRESS_ENGINE_H
+
+#include <string>
+#include <vector>
+#include "../crow_all.h"
+#include <mlpack.hpp>
+#include "../encoder/CategoricalEncoder.h"
+#include "../portfolio/PortfolioReader.h"
+#include "../scoring/ModelSet.h"
+
+// A change to one feature, applied to every row of a scenario.
+struct Shock {
+  enum class Kind { Scale, Add, Set };
+
+  size_t dimension;
+  Kind kind;
+  double value;  // Factor, offset, or the encoded value to set
+};
+
+struct Scenario {
+  std::string name;
+  std::vector<Shock> shocks;
+};
+
+// PD distribution of the book under one scenario, and its shift from the
+// unshocked baseline.
+struct ScenarioResult {
+  std::string name;
+  size_t rows;
+  double meanPd;
+  double meanShift;      // Mean of PD - baseline PD
+  double meanAbsShift;
+  double p50;
+  double p90;
+  double p99;
+  double aboveCutoff;    // Fraction of rows with PD >= cutoff
+  size_t crossedUp;      // Rows moved from below the cutoff to at or above it
+  size_t crossedDown;
+};
+
+// Re-scores a book of encoded customers under stress scenarios such as
+// "MonthlyCharges +20%" or "every Contract is Month-to-month".
+//
+// The book is never copied per scenario. Work is split into (scenario, row
+// block) items run in parallel. Each item copies one block of rows into the
+// thread's scratch matrix, applies the scenario's shocks there and scores
+// the block. Every thread accumulates sums and a PD histogram per scenario,
+// merged at the end, so memory does not grow with the book.
+class StressEngine {
+public:
+  StressEngine(CategoricalEncoder const &encoder,
+               std::vector<std::string> const &fieldNames,
+               ModelSet const &models,
+               PortfolioReader::PdModel model,
+               size_t threads = 0);
+
+  // Reads a JSON array of scenarios:
+  //   [{"name": "charges up", "shocks": [{"field": "MonthlyCharges", "scale": 1.2},
+  //                                      {"field": "tenure", "add": -6},
+  //                                      {"field": "Contract", "set": "Month-to-month"}]}]
+  // Categorical fields can only be set, to a category seen in training.
+  // Throws std::invalid_argument for anything else.
+  std::vector<Scenario> ParseScenarios(crow::json::rvalue const &body) const;
+
+  // Scores every column of data under each scenario. The first result is the
+  // baseline, with no shocks.
+  std::vector<ScenarioResult> Run(const arma::mat &data,
+                                  std::vector<Scenario> const &scenarios,
+                                  double cutoff = 0.5) const;
+
+  static std::string Report(std::vector<ScenarioResult> const &results, double cutoff);
+
+  static const size_t MAX_SCENARIOS = 64;
+  static const size_t BLOCK_ROWS = 256;
+  static const size_t PD_BINS = 1024;
+
+private:
+  CategoricalEncoder const &encoder;
+  std::vector<std::string> fieldNames;
+  ModelSet const &models;
+  PortfolioReader::PdModel model;
+  size_t threads;
+
+  double score(ModelSet::Snapshot const &snapshot, const double *encoded) const;
+};
+
+#endif // MLPACK_PROJECT_STRESS_ENGINE_H
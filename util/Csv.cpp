@@ -0,0 +1,50 @@
+#include "Csv.h"
+
+void splitCsvLine(const char *begin, const char *end, std::vector<CsvField> &fields) {
+  fields.clear();
+  const char *p = begin;
+  while (true) {
+    const char *start = p;
+    const char *stop;
+    if (p < end && *p == '"') {
+      start = ++p;
+      while (p < end && !(*p == '"' && (p + 1 == end || p[1] != '"')))
+        p += (*p == '"') ? 2 : 1;
+      stop = p;
+      if (p < end)
+        ++p;  // Closing quote.
+      while (p < end && *p != ',')
+        ++p;
+    } else {
+      while (p < end && *p != ',')
+        ++p;
+      stop = p;
+    }
+    fields.emplace_back(start, stop - start);
+    if (p >= end)
+      return;
+    ++p;  // Comma.
+  }
+}
+
+CsvField trimCsvField(CsvField field) {
+  const char *begin = field.first;
+  const char *end = begin + field.second;
+  while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '\r'))
+    ++begin;
+  while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+    --end;
+  return CsvField(begin, end - begin);
+}
+
+size_t readCsvLines(std::istream &in, std::vector<std::string> &lines, size_t maxRows) {
+  lines.resize(maxRows);
+  size_t n = 0;
+  while (n < maxRows && std::getline(in, lines[n])) {
+    if (!lines[n].empty() && lines[n].back() == '\r')
+      lines[n].pop_back();
+    if (!lines[n].empty())
+      ++n;
+  }
+  return n;
+}
@@ -0,0 +1,26 @@
+#ifndef MLPACK_PROJECT_CSV_H
+#define MLPACK_PROJECT_CSV_H
+
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef std::pair<const char *, size_t> CsvField;
+
+// Splits the line [begin, end) into (pointer, length) fields, honouring double
+// quotes. Quotes are stripped; escaped quotes inside a field are kept doubled.
+void splitCsvLine(const char *begin, const char *end, std::vector<CsvField> &fields);
+
+inline void splitCsvLine(std::string const &line, std::vector<CsvField> &fields) {
+  splitCsvLine(line.data(), line.data() + line.size(), fields);
+}
+
+// Drops leading and trailing whitespace, like mlpack's CSV loader.
+CsvField trimCsvField(CsvField field);
+
+// Reads up to maxRows non-empty lines, without trailing '\r', reusing the
+// strings already in `lines`. Returns the number read.
+size_t readCsvLines(std::istream &in, std::vector<std::string> &lines, size_t maxRows);
+
+#endif // MLPACK_PROJECT_CSV_H
@@ -0,0 +1,14 @@
+#ifndef MLPACK_PROJECT_JSON_H
+#define MLPACK_PROJECT_JSON_H
+
+#include <cstdio>
+#include <string>
+
+// Appends value with `digits` significant digits; 17 round-trips a double.
+inline void appendNumber(std::string &out, double value, int digits = 17) {
+  char buffer[32];
+  int size = std::snprintf(buffer, sizeof(buffer), "%.*g", digits, value);
+  out.append(buffer, size);
+}
+
+#endif // MLPACK_PROJECT_JSON_H
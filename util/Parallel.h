@@ -0,0 +1,62 @@
+#ifndef MLPACK_PROJECT_PARALLEL_H
+#define MLPACK_PROJECT_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of worker threads to use when the caller does not specify one.
+inline size_t defaultThreadCount() {
+  return std::max<unsigned>(1, std::thread::hardware_concurrency());
+}
+
+// Runs fn(worker, begin, end) over [0, n) in blocks of `grain` items.
+// Workers claim blocks from a shared counter, so uneven blocks balance out.
+// `worker` is in [0, threads) and lets callers index per-thread scratch space.
+// Runs inline when there is only one thread. If fn throws, the
+// remaining blocks are skipped and the first exception is rethrown here.
+template<typename F>
+void parallelFor(size_t n, size_t grain, F fn, size_t threads = 0) {
+  if (n == 0)
+    return;
+  grain = std::max<size_t>(1, grain);
+  const size_t blocks = (n + grain - 1) / grain;
+  threads = std::min(threads == 0 ? defaultThreadCount() : threads, blocks);
+
+  if (threads <= 1) {
+    for (size_t begin = 0; begin < n; begin += grain)
+      fn(size_t(0), begin, std::min(n, begin + grain));
+    return;
+  }
+
+  std::atomic<size_t> next(0);
+  std::exception_ptr error;
+  std::mutex errorMutex;
+  auto work = [&](size_t worker) {
+    try {
+      for (size_t block = next++; block < blocks; block = next++) {
+        const size_t begin = block * grain;
+        fn(worker, begin, std::min(n, begin + grain));
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if (!error)
+        error = std::current_exception();
+      next = blocks;
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (size_t t = 1; t < threads; ++t)
+    pool.emplace_back(work, t);
+  work(0);
+  for (auto &thread : pool)
+    thread.join();
+  if (error)
+    std::rethrow_exception(error);
+}
+
+#endif // MLPACK_PROJECT_PARALLEL_H
@@ -0,0 +1,18 @@
+#ifndef MLPACK_PROJECT_RANDOM_H
+#define MLPACK_PROJECT_RANDOM_H
+
+#include <cstdint>
+
+// splitmix64 finalizer. Used as a counter-based generator: hashing the seed
+// with a task, resample or scenario index gives each one its own stream, so
+// parallel results do not depend on which thread ran what.
+inline uint64_t mix(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+#endif // MLPACK_PROJECT_RANDOM_H